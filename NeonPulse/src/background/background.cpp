@@ -1,5 +1,6 @@
 #include "background.h"
 #include "../utils/utils.h"
+#include "../profiler/profiler.h"
 #include <cmath>
 
 using namespace std;
@@ -9,9 +10,27 @@ using namespace std;
 // Background rendering implementation
 // -------------------------
 
+void BuildParallaxField(ParallaxField& field, const LevelVector<ParallaxLayer>& layers) {
+    field.shapes.clear();
+    for (const auto& layer : layers) {
+        int count = layer.density;
+        for (int i = 0; i < count; ++i) {
+            float t = (float)i / (float)count;
+            ParallaxShape shape;
+            shape.phaseX = t * 9000.0f;
+            shape.offsetX = t * 140.0f;
+            shape.y = sinf(t * 12.1f) * 0.5f + 0.5f;
+            shape.size = layer.scaleMin + (layer.scaleMax - layer.scaleMin) * (0.5f + 0.5f * sinf(t * 7.9f));
+            shape.circle = (i + count) % 3 == 0;
+            field.shapes.push_back(shape);
+        }
+    }
+}
+
 void DrawBackground(int screenW, int screenH, const Section& sec, float camX,
-    const vector<ParallaxLayer>& layers, float beatPulse) {
+    const LevelVector<ParallaxLayer>& layers, const ParallaxField& field, float beatPulse) {
     DrawRectangleGradientV(0, 0, screenW, screenH, sec.bgA, sec.bgB);
+    CountDraw(RENDER_BACKGROUND, kVertsRect);
 
     int bandH = screenH / 8;
     Color bandColor = {
@@ -22,17 +41,21 @@ void DrawBackground(int screenW, int screenH, const Section& sec, float camX,
     };
     DrawRectangleGradientH(0, screenH / 2 - bandH / 2, screenW, bandH,
         Fade(bandColor, 0.08f), Fade(bandColor, 0.24f));
+    CountDraw(RENDER_BACKGROUND, kVertsRect);
 
+    const ParallaxShape* shape = field.shapes.data();
+    const ParallaxShape* fieldEnd = shape + field.shapes.size();
     for (const auto& layer : layers) {
-        int count = layer.density;
-        for (int i = 0; i < count; ++i) {
-            float t = (float)i / (float)count;
-            float x = fmodf(camX * layer.speed + t * 9000.0f, (float)screenW) - screenW * 0.5f + t * 140.0f;
-            float y = (sinf(t * 12.1f) * 0.5f + 0.5f) * screenH;
-            float size = layer.scaleMin + (layer.scaleMax - layer.scaleMin) * (0.5f + 0.5f * sinf(t * 7.9f));
-            Color c = Fade(layer.color, 0.22f + 0.16f * beatPulse);
+        Color c = Fade(layer.color, 0.22f + 0.16f * beatPulse);
+        for (int i = 0; i < layer.density && shape != fieldEnd; ++i, ++shape) {
+            float x = fmodf(camX * layer.speed + shape->phaseX, (float)screenW) - screenW * 0.5f + shape->offsetX;
+            float y = shape->y * screenH;
+            float size = shape->size;
 
-            if ((i + count) % 3 == 0) DrawCircle((int)x, (int)y, size, c);
+            if (shape->circle) {
+                DrawCircle((int)x, (int)y, size, c);
+                CountDraw(RENDER_BACKGROUND, kVertsCircle);
+            }
             else {
                 Vector2 center = { x, y };
                 Vector2 a = { center.x, center.y - size };
@@ -41,6 +64,8 @@ void DrawBackground(int screenW, int screenH, const Section& sec, float camX,
                 Vector2 e = { center.x, center.y + size };
                 DrawTriangle(a, b, d, c);
                 DrawTriangle(b, e, d, c);
+                CountDraw(RENDER_BACKGROUND, kVertsTriangle);
+                CountDraw(RENDER_BACKGROUND, kVertsTriangle);
             }
         }
     }
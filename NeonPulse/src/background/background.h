@@ -2,12 +2,29 @@
 #include "raylib.h"
 #include <vector>
 #include "../entities/entities.h"
+#include "../memory/memory.h"
 
 // -------------------------
 // Background rendering
 // -------------------------
-// Draws the background with parallax layers and beat effects
+// Draws the background with parallax layers and beat effects. The shapes
+// of every layer are laid out once per level into a ParallaxField; a frame
+// only scrolls them.
 // -------------------------
 
+struct ParallaxShape {
+    float phaseX;  // scroll offset before wrapping to the screen
+    float offsetX; // added after wrapping
+    float y;       // fraction of the screen height
+    float size;
+    bool circle;   // else a diamond
+};
+
+struct ParallaxField {
+    std::vector<ParallaxShape> shapes; // layer by layer, layer.density each
+};
+
+void BuildParallaxField(ParallaxField& field, const LevelVector<ParallaxLayer>& layers);
+
 void DrawBackground(int screenW, int screenH, const Section& sec, float camX,
-    const std::vector<ParallaxLayer>& layers, float beatPulse);
+    const LevelVector<ParallaxLayer>& layers, const ParallaxField& field, float beatPulse);
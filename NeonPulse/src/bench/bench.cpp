@@ -0,0 +1,330 @@
+#include "bench.h"
+#include "raylib.h"
+#include "../entities/entities.h"
+#include "../collision/collision.h"
+#include "../level/level.h"
+#include "../spatial/spatial.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+using namespace std;
+
+// -------------------------
+// Helpers
+// -------------------------
+
+typedef chrono::steady_clock BenchClock;
+
+// Results are written here so the timed loops cannot be optimized away
+static volatile long long gBenchSink;
+
+static double ElapsedNs(BenchClock::time_point t0) {
+    return (double)chrono::duration_cast<chrono::nanoseconds>(BenchClock::now() - t0).count();
+}
+
+// Same layout as addSpikeClusterLocal in BuildLevel
+static void MakeSpikeCluster(vector<Spike>& spikes, int count, bool up) {
+    const float w = 36.0f, h = 70.0f;
+    spikes.clear();
+    for (int i = 0; i < count; i++) {
+        float x = 1000.0f + i * (w * 0.86f);
+        float y = up ? (defaultFloorY - h) : (ceilingYTop);
+        spikes.push_back({ { x, y, w, h }, up, neonYellow });
+    }
+}
+
+// Player positions sweeping across the cluster: running over the top
+// (misses), grazing the tips and running into it (hits)
+static void MakeQueries(vector<Rectangle>& queries, const vector<Spike>& spikes, int count) {
+    float x0 = spikes.front().base.x - 60.0f;
+    float x1 = spikes.back().base.x + spikes.back().base.width + 20.0f;
+    const float heights[] = { 120.0f, 74.0f, 60.0f, 36.0f };
+    queries.clear();
+    for (int i = 0; i < count; ++i) {
+        float x = x0 + (x1 - x0) * (float)i / (float)count;
+        float lift = heights[i % 4];
+        queries.push_back({ x, defaultFloorY - 36.0f - lift, 36.0f, 36.0f });
+    }
+}
+
+// Packs one cluster as a single run, positioned from the chunk holding its
+// first spike, and snaps the spikes to what the kernels see
+static float PackCluster(PackedSpikes& packed, vector<Spike>& spikes) {
+    float originX = floorf(spikes[0].base.x / kChunkWidth) * kChunkWidth;
+    packed.shapes.assign(1, MakeSpikeShape(spikes[0].base.width, spikes[0].base.height, spikes[0].up));
+    packed.x.clear();
+    packed.y.clear();
+    packed.color.assign(spikes.size(), 0);
+    packed.runs.assign(1, { 0, (int)spikes.size(), 0, INT16_MAX, INT16_MIN });
+    for (auto& s : spikes) {
+        int i = (int)packed.x.size();
+        packed.x.push_back(QuantizeCoord(s.base.x - originX));
+        packed.runs[0].minX = min(packed.runs[0].minX, packed.x[i]);
+        packed.runs[0].maxX = max(packed.runs[0].maxX, packed.x[i]);
+        packed.y.push_back(QuantizeCoord(s.base.y));
+        s.base.x = PackedSpikeX(packed, originX, i);
+        s.base.y = PackedSpikeY(packed, i);
+    }
+    PadPackedSpikes(packed);
+    return originX;
+}
+
+// The collision path before packed kernels: cull, then CollideSpike per spike
+static int FirstHitPerSpike(const vector<Spike>& spikes, const Rectangle& player) {
+    for (int i = 0; i < (int)spikes.size(); ++i) {
+        const Spike& s = spikes[i];
+        if (player.x + player.width > s.base.x - 20 && player.x < s.base.x + s.base.width + 20) {
+            if (CollideSpike(player, s)) return i;
+        }
+    }
+    return -1;
+}
+
+// -------------------------
+// Spike collision
+// -------------------------
+
+int RunSpikeBenchmark() {
+    // The largest cluster still fits the +-4096 px reach of packed coordinates
+    const int clusterSizes[] = { 1, 4, 8, 16, 30, 64, 128 };
+    const int queryCount = 4096;
+    const int repeats = 200;
+
+    vector<Spike> spikes;
+    vector<Rectangle> queries;
+    PackedSpikes packed;
+    bool agree = true;
+
+    printf("spike collision benchmark (kernel: %s), ns per query\n", SpikeKernelName());
+    printf("  %8s %12s %12s %12s %9s\n", "spikes", "per-spike", "pack scalar", "pack simd", "speedup");
+
+    for (int size : clusterSizes) {
+        MakeSpikeCluster(spikes, size, true);
+        float originX = PackCluster(packed, spikes);
+        MakeQueries(queries, spikes, queryCount);
+
+        // All paths must report the same first hit
+        for (const auto& q : queries) {
+            int ref = FirstHitPerSpike(spikes, q);
+            if (FirstSpikeHitScalar(packed, 0, 1, originX, q) != ref || FirstSpikeHit(packed, 0, 1, originX, q) != ref) {
+                printf("  MISMATCH at %d spikes, player x %.1f y %.1f\n", size, q.x, q.y);
+                agree = false;
+                break;
+            }
+        }
+
+        long long sink = 0;
+        double total = (double)queryCount * repeats;
+
+        BenchClock::time_point t0 = BenchClock::now();
+        for (int r = 0; r < repeats; ++r) for (const auto& q : queries) sink += FirstHitPerSpike(spikes, q);
+        double perSpikeNs = ElapsedNs(t0) / total;
+
+        t0 = BenchClock::now();
+        for (int r = 0; r < repeats; ++r) for (const auto& q : queries) sink += FirstSpikeHitScalar(packed, 0, 1, originX, q);
+        double scalarNs = ElapsedNs(t0) / total;
+
+        t0 = BenchClock::now();
+        for (int r = 0; r < repeats; ++r) for (const auto& q : queries) sink += FirstSpikeHit(packed, 0, 1, originX, q);
+        double simdNs = ElapsedNs(t0) / total;
+
+        gBenchSink = sink;
+
+        printf("  %8d %12.2f %12.2f %12.2f %8.2fx\n", size, perSpikeNs, scalarNs, simdNs, perSpikeNs / simdNs);
+    }
+
+    printf("spike collision benchmark: %s\n", agree ? "PASS" : "FAIL");
+    return agree ? 0 : 1;
+}
+
+// -------------------------
+// Level memory
+// -------------------------
+
+// A long level in the style of BuildLevel: spike clusters from a few
+// shapes and the neon colors, pads and platforms in between
+static void MakeLongLevel(Level& level, float length) {
+    const Vector2 shapes[] = { { 36.0f, 56.0f }, { 36.0f, 70.0f }, { 40.0f, 60.0f }, { 30.0f, 48.0f } };
+    const Color colors[] = { neonYellow, neonMagenta, neonCyan, neonGreen };
+
+    SetRandomSeed(7);
+    level.sections.push_back({ 0.0f, length, { 8, 12, 26, 255 }, { 18, 26, 64, 255 } });
+    float x = 600.0f;
+    while (x < length) {
+        const Vector2& shape = shapes[GetRandomValue(0, 3)];
+        bool up = GetRandomValue(0, 3) != 0;
+        Color c = colors[GetRandomValue(0, 3)];
+        int count = GetRandomValue(1, 8);
+        for (int i = 0; i < count; i++) {
+            float sx = x + i * (shape.x * 0.86f);
+            float sy = up ? (defaultFloorY - shape.y) : ceilingYTop;
+            level.spikes.push_back({ { sx, sy, shape.x, shape.y }, up, c });
+        }
+        x += count * shape.x + GetRandomValue(140, 420);
+
+        switch (GetRandomValue(0, 9)) {
+        case 0: level.jumpPads.push_back({ { x, defaultFloorY - 32, 60, 16 }, 1.45f, neonYellow }); break;
+        case 1: level.speedPads.push_back({ { x, defaultFloorY - 8, 66, 8 }, 1.35f, 0.9f, neonGreen }); break;
+        case 2: level.gravityPads.push_back({ { x, defaultFloorY - 24, 56, 16 }, neonPurple, true }); break;
+        case 3: level.platforms.push_back({ { x, defaultFloorY - 140, 160, 18 }, 60.0f, 0.4f, false, neonBlue, 0.0f }); break;
+        default: break;
+        }
+        x += 200.0f;
+    }
+    level.finishLine = { length, ceilingYTop, 24, defaultFloorY - ceilingYTop };
+}
+
+// The chunk layout before packing: full entity copies per chunk plus float
+// hull arrays padded to kSpikeLanes
+struct UnpackedChunk {
+    uint64_t hash;
+    vector<MovingPlatform> platforms;
+    vector<Spike> spikes;
+    int hullCount;
+    vector<float> hulls[8];
+    vector<JumpPad> jumpPads;
+    vector<SpeedPad> speedPads;
+    vector<GravityPad> gravityPads;
+};
+
+static size_t UnpackedGridBytes(const ChunkGrid& grid) {
+    size_t bytes = grid.chunks.size() * sizeof(UnpackedChunk);
+    for (const auto& chunk : grid.chunks) {
+        size_t spikes = 0;
+        for (const auto& run : Items(grid.spikes.runs, chunk.spikeRuns)) spikes += run.count;
+        size_t padded = (spikes + kSpikeLanes - 1) / kSpikeLanes * kSpikeLanes;
+        bytes += chunk.platforms.count * sizeof(MovingPlatform);
+        bytes += spikes * sizeof(Spike) + padded * 8 * sizeof(float);
+        bytes += chunk.jumpPads.count * sizeof(JumpPad) + chunk.speedPads.count * sizeof(SpeedPad) +
+            chunk.gravityPads.count * sizeof(GravityPad);
+    }
+    return bytes;
+}
+
+// Spikes of a chunk, decoded in packed order
+static void UnpackChunkSpikes(const ChunkGrid& grid, const LevelChunk& chunk, vector<Spike>& out) {
+    out.clear();
+    for (const auto& run : Items(grid.spikes.runs, chunk.spikeRuns)) {
+        for (int i = run.first; i < run.first + run.count; ++i) out.push_back(UnpackSpike(grid, chunk, run, i));
+    }
+}
+
+int RunMemoryBenchmark() {
+    const float length = 2000000.0f;
+    const int queryCount = 200000;
+
+    Level level;
+    MakeLongLevel(level, length);
+    UpdateChunkGrid(level.grid, level);
+    const ChunkGrid& grid = level.grid;
+
+    printf("level memory benchmark: %.0f px, %d chunks\n", length, (int)grid.chunks.size());
+    printf("  %d spikes, %d platforms, %d pads\n", (int)level.spikes.size(), (int)level.platforms.size(),
+        (int)(level.jumpPads.size() + level.speedPads.size() + level.gravityPads.size()));
+    printf("  tables: %d spike shapes, %d pad sizes, %d colors\n", (int)grid.spikes.shapes.size(),
+        (int)grid.padSizes.size(), (int)grid.palette.size());
+
+    // Every packed spike must decode to its source, snapped to kCoordStep
+    bool exact = true;
+    float worstError = 0.0f;
+    vector<int> cursor(grid.chunks.size(), 0);
+    vector<vector<Spike>> decoded(grid.chunks.size());
+    for (int c = 0; c < (int)grid.chunks.size(); ++c) UnpackChunkSpikes(grid, grid.chunks[c], decoded[c]);
+    for (const auto& s : level.spikes) {
+        int c = max(0, min((int)grid.chunks.size() - 1, (int)floorf(s.base.x / kChunkWidth)));
+        const Spike& d = decoded[c][cursor[c]++];
+        worstError = fmaxf(worstError, fmaxf(fabsf(d.base.x - s.base.x), fabsf(d.base.y - s.base.y)));
+        if (d.up != s.up || d.base.width != s.base.width || d.base.height != s.base.height ||
+            d.color.r != s.color.r || d.color.g != s.color.g || d.color.b != s.color.b || d.color.a != s.color.a) {
+            exact = false;
+        }
+    }
+    exact = exact && worstError <= kCoordStep * 0.5f;
+
+    // The packed kernel must agree with CollideSpike on the decoded spikes,
+    // and so must the float hulls it is timed against
+    vector<FloatHulls> hulls(grid.chunks.size());
+    for (int c = 0; c < (int)grid.chunks.size(); ++c) BuildFloatHulls(hulls[c], decoded[c]);
+    SetRandomSeed(11);
+    vector<Rectangle> queries;
+    for (int i = 0; i < queryCount; ++i) {
+        float x = (float)GetRandomValue(0, (int)length);
+        float y = (float)GetRandomValue((int)ceilingYTop - 20, (int)defaultFloorY - 16);
+        queries.push_back({ x, y, 36.0f, 36.0f });
+    }
+    auto packedHit = [&](const Rectangle& q) {
+        ChunkSpan span = ChunksOverlapping(grid, q.x, q.x + q.width);
+        for (int c = span.first; c <= span.last; ++c) {
+            if (FirstSpikeHit(grid, grid.chunks[c], q) >= 0) return true;
+        }
+        return false;
+    };
+    auto hullHit = [&](const Rectangle& q) {
+        ChunkSpan span = ChunksOverlapping(grid, q.x, q.x + q.width);
+        for (int c = span.first; c <= span.last; ++c) {
+            if (FirstFloatHullHit(hulls[c], q) >= 0) return true;
+        }
+        return false;
+    };
+    auto referenceHit = [&](const Rectangle& q) {
+        ChunkSpan span = ChunksOverlapping(grid, q.x, q.x + q.width);
+        for (int c = span.first; c <= span.last; ++c) {
+            if (FirstHitPerSpike(decoded[c], q) >= 0) return true;
+        }
+        return false;
+    };
+    bool agree = true;
+    for (const auto& q : queries) {
+        bool expected = referenceHit(q);
+        if (packedHit(q) != expected || hullHit(q) != expected) {
+            printf("  MISMATCH at player x %.1f y %.1f\n", q.x, q.y);
+            agree = false;
+            break;
+        }
+    }
+
+    // Best of a few interleaved rounds, so one noisy round cannot decide the
+    // gate. Both sides run the kernel dispatch picked for this CPU; the
+    // packed one skips runs away from the player and should not be slower
+    // than the hulls it replaced. Past maxSlowdown it is a regression.
+    const int rounds = 9;
+    const double maxSlowdown = 1.05;
+    double hullNs = 1e30, packedNs = 1e30;
+    long long sink = 0;
+    for (int r = 0; r < rounds; ++r) {
+        BenchClock::time_point t0 = BenchClock::now();
+        for (const auto& q : queries) sink += hullHit(q);
+        hullNs = min(hullNs, ElapsedNs(t0) / queryCount);
+        t0 = BenchClock::now();
+        for (const auto& q : queries) sink += packedHit(q);
+        packedNs = min(packedNs, ElapsedNs(t0) / queryCount);
+    }
+    gBenchSink = sink;
+    bool fastEnough = packedNs <= hullNs * maxSlowdown;
+
+    // Whole level: the float lists stayed next to the unpacked grid; the
+    // packed grid replaces them once ReleaseEntityLists has run
+    size_t spikeCount = level.spikes.size();
+    size_t listBytes = level.arena.BytesUsed() + level.entityArena.BytesUsed();
+    size_t unpackedGrid = UnpackedGridBytes(grid);
+    size_t packedGrid = ChunkGridBytes(grid);
+    ReleaseEntityLists(level);
+    size_t before = listBytes + unpackedGrid;
+    size_t after = level.arena.BytesUsed() + level.entityArena.BytesUsed() + packedGrid;
+    double ratio = (double)before / (double)after;
+    printf("  chunk grid, full structs + float hulls: %10zu bytes (%.1f per spike)\n", unpackedGrid, (double)unpackedGrid / spikeCount);
+    printf("  chunk grid, packed:                     %10zu bytes (%.1f per spike)\n", packedGrid, (double)packedGrid / spikeCount);
+    printf("  level, lists + unpacked grid:           %10zu bytes (%.1f per spike)\n", before, (double)before / spikeCount);
+    printf("  level, packed grid, lists released:     %10zu bytes (%.1f per spike)\n", after, (double)after / spikeCount);
+    printf("  reduction %.2fx\n", ratio);
+    printf("  worst position error %.4f px (step %.4f)\n", worstError, kCoordStep);
+    printf("  spike query over the grid: %.1f ns float hulls, %.1f ns packed %s (%.2fx, limit %.2fx)\n", hullNs, packedNs,
+        SpikeKernelName(), packedNs / hullNs, maxSlowdown);
+
+    bool pass = exact && agree && ratio >= 3.0 && fastEnough;
+    printf("level memory benchmark: %s\n", pass ? "PASS" : "FAIL");
+    return pass ? 0 : 1;
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+// -------------------------
+// Micro-benchmarks
+// -------------------------
+// Command-line only, no window: NeonPulse --bench-spikes | --bench-memory
+// Each benchmark prints a table to stdout and returns the process exit
+// code (non-zero when the paths it compares disagree).
+// -------------------------
+
+// Per-spike CollideSpike loop vs the packed kernels, over cluster sizes
+// like the ones addSpikeClusterLocal builds.
+int RunSpikeBenchmark();
+
+// Bytes of a long generated level: float lists plus full-struct grid vs
+// the packed grid alone (lists released), with decode and collision checks
+// against the source entities. Fails below a 3x cut, or if the packed
+// spike kernel is slower than the float hulls it replaced (FloatHulls).
+int RunMemoryBenchmark();
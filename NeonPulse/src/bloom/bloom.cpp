@@ -0,0 +1,151 @@
+#include "bloom.h"
+#include "rlgl.h"
+#include "../profiler/profiler.h"
+#include "../utils/utils.h"
+
+// -------------------------
+// Tuning
+// -------------------------
+
+static const int kDownsample = 4;
+static const float kThreshold = 0.35f;      // brightest channel where glow starts
+static const float kBaseIntensity = 0.45f;
+static const float kBeatIntensity = 0.45f;  // added on the beat, decays with the pulse
+static const int kBlurIterations = 2;       // H+V pairs; more widens the glow
+
+// -------------------------
+// Shaders (raylib default vertex shader)
+// -------------------------
+
+static const char* kBrightPassFs = R"(#version 330
+in vec2 fragTexCoord;
+in vec4 fragColor;
+uniform sampler2D texture0;
+uniform float threshold;
+uniform vec2 texel; // one source texel
+out vec4 finalColor;
+
+vec3 Bright(vec2 uv) {
+    vec3 c = texture(texture0, uv).rgb;
+    float peak = max(c.r, max(c.g, c.b));
+    return c * smoothstep(threshold, 1.0, peak);
+}
+
+// An output pixel covers 4x4 source texels. Each bilinear tap, one texel
+// off the center diagonally, averages a 2x2 quarter of them, so every
+// texel counts and thin edges cannot fall between samples.
+void main() {
+    finalColor = vec4((Bright(fragTexCoord + vec2(-texel.x, -texel.y)) + Bright(fragTexCoord + vec2(texel.x, -texel.y)) +
+        Bright(fragTexCoord + vec2(-texel.x, texel.y)) + Bright(fragTexCoord + vec2(texel.x, texel.y))) * 0.25, 1.0);
+}
+)";
+
+static const char* kBlurFs = R"(#version 330
+in vec2 fragTexCoord;
+in vec4 fragColor;
+uniform sampler2D texture0;
+uniform vec2 direction; // one texel along the blur axis
+out vec4 finalColor;
+
+const float weights[5] = float[](0.227027, 0.1945946, 0.1216216, 0.054054, 0.016216);
+
+void main() {
+    vec3 sum = texture(texture0, fragTexCoord).rgb * weights[0];
+    for (int i = 1; i < 5; ++i) {
+        sum += texture(texture0, fragTexCoord + direction * float(i)).rgb * weights[i];
+        sum += texture(texture0, fragTexCoord - direction * float(i)).rgb * weights[i];
+    }
+    finalColor = vec4(sum, 1.0);
+}
+)";
+
+// -------------------------
+// Bloom
+// -------------------------
+
+void Bloom::Init(int w, int h) {
+    screenW = w;
+    screenH = h;
+    width = w / kDownsample;
+    height = h / kDownsample;
+
+    brightPass = LoadShaderFromMemory(nullptr, kBrightPassFs);
+    blur = LoadShaderFromMemory(nullptr, kBlurFs);
+
+    // A shader that fails to compile comes back invalid (id 0), one that
+    // fails to link as raylib's default shader
+    unsigned int defaultId = rlGetShaderIdDefault();
+    enabled = IsShaderValid(brightPass) && IsShaderValid(blur) &&
+        brightPass.id != defaultId && blur.id != defaultId;
+    if (!enabled) {
+        TraceLog(LOG_WARNING, "BLOOM: shaders unavailable, drawing without glow");
+        return;
+    }
+
+    thresholdLoc = GetShaderLocation(brightPass, "threshold");
+    texelLoc = GetShaderLocation(brightPass, "texel");
+    directionLoc = GetShaderLocation(blur, "direction");
+    SetShaderValue(brightPass, thresholdLoc, &kThreshold, SHADER_UNIFORM_FLOAT);
+
+    ping = LoadRenderTexture(width, height);
+    pong = LoadRenderTexture(width, height);
+    SetTextureFilter(ping.texture, TEXTURE_FILTER_BILINEAR);
+    SetTextureFilter(pong.texture, TEXTURE_FILTER_BILINEAR);
+}
+
+void Bloom::Unload() {
+    if (ping.id != 0) UnloadRenderTexture(ping);
+    if (pong.id != 0) UnloadRenderTexture(pong);
+    if (brightPass.id != 0 && brightPass.id != rlGetShaderIdDefault()) UnloadShader(brightPass);
+    if (blur.id != 0 && blur.id != rlGetShaderIdDefault()) UnloadShader(blur);
+    ping = { 0 };
+    pong = { 0 };
+    brightPass = { 0 };
+    blur = { 0 };
+    enabled = false;
+}
+
+void Bloom::Blur(RenderTexture2D from, RenderTexture2D to, float dx, float dy) {
+    float direction[2] = { dx, dy };
+    SetShaderValue(blur, directionLoc, direction, SHADER_UNIFORM_VEC2);
+
+    BeginTextureMode(to);
+    BeginShaderMode(blur);
+    // render textures are stored bottom-up, so each copy flips back
+    DrawTextureRec(from.texture, { 0.0f, 0.0f, (float)width, (float)-height }, { 0.0f, 0.0f }, WHITE);
+    EndShaderMode();
+    EndTextureMode();
+    CountDraw(RENDER_POST, kVertsRect);
+}
+
+void Bloom::Render(Texture2D source, Rectangle sourceRect) {
+    if (!enabled) return;
+
+    // Bright pass straight into quarter resolution, box-filtered in the shader
+    float texel[2] = { 1.0f / source.width, 1.0f / source.height };
+    SetShaderValue(brightPass, texelLoc, texel, SHADER_UNIFORM_VEC2);
+    BeginTextureMode(ping);
+    ClearBackground(BLACK);
+    BeginShaderMode(brightPass);
+    DrawTexturePro(source, sourceRect, { 0.0f, 0.0f, (float)width, (float)height }, { 0.0f, 0.0f }, 0.0f, WHITE);
+    EndShaderMode();
+    EndTextureMode();
+    CountDraw(RENDER_POST, kVertsRect);
+
+    for (int i = 0; i < kBlurIterations; ++i) {
+        Blur(ping, pong, 1.0f / width, 0.0f);
+        Blur(pong, ping, 0.0f, 1.0f / height);
+    }
+}
+
+void Bloom::Composite(float pulse) const {
+    if (!enabled) return;
+
+    float intensity = Clamp1(kBaseIntensity + kBeatIntensity * pulse, 0.0f, 1.0f);
+    BeginBlendMode(BLEND_ADDITIVE);
+    DrawTexturePro(ping.texture, { 0.0f, 0.0f, (float)width, (float)-height },
+        { 0.0f, 0.0f, (float)screenW, (float)screenH }, { 0.0f, 0.0f }, 0.0f, Fade(WHITE, intensity));
+    EndBlendMode();
+    CountDraw(RENDER_POST, kVertsRect);
+    CountBlendChange();
+}
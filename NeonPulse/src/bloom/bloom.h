@@ -0,0 +1,48 @@
+#pragma once
+#include "raylib.h"
+
+// -------------------------
+// Bloom post-process
+// -------------------------
+// Bright parts of the world pass are extracted into a quarter-resolution
+// target (4-tap box filter, so every world texel contributes), blurred with a separable Gaussian (horizontal then vertical
+// pass, ping-ponging between two targets) and added back on top of the
+// frame. The cost is a fixed handful of quarter-size passes, independent
+// of how many entities are on screen. The intensity follows the beat.
+//
+// Needs GLSL 330 (any GL 3.3 context, llvmpipe included). When the
+// shaders do not compile the passes are skipped and the frame is drawn
+// without glow.
+// -------------------------
+
+class Bloom {
+public:
+    void Init(int screenW, int screenH);
+    void Unload();
+    bool Enabled() const { return enabled; }
+
+    // Bright pass + blur of a region of the world texture. sourceRect is
+    // in texture pixels and may be flipped (negative height), as for
+    // DrawTexturePro. Call outside any texture mode.
+    void Render(Texture2D source, Rectangle sourceRect);
+
+    // Adds the blurred glow over the current target; pulse is BeatPulse().
+    void Composite(float pulse) const;
+
+private:
+    void Blur(RenderTexture2D from, RenderTexture2D to, float dx, float dy);
+
+    Shader brightPass = { 0 };
+    Shader blur = { 0 };
+    int thresholdLoc = -1;
+    int texelLoc = -1;
+    int directionLoc = -1;
+
+    RenderTexture2D ping = { 0 };
+    RenderTexture2D pong = { 0 };
+    int screenW = 0;
+    int screenH = 0;
+    int width = 0;   // quarter-resolution size
+    int height = 0;
+    bool enabled = false;
+};
@@ -0,0 +1,310 @@
+#include "collision.h"
+#include "kernels.h"
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SPIKE_KERNEL_SSE2
+#include <emmintrin.h>
+#endif
+
+using namespace std;
+
+// -------------------------
+// Packing
+// -------------------------
+
+int16_t QuantizeCoord(float v, bool* clamped) {
+    long q = lroundf(v / kCoordStep);
+    bool out = q < INT16_MIN || q > INT16_MAX;
+    if (clamped) *clamped = out;
+    if (q < INT16_MIN) q = INT16_MIN;
+    if (q > INT16_MAX) q = INT16_MAX;
+    return (int16_t)q;
+}
+
+SpikeShape MakeSpikeShape(float width, float height, bool up) {
+    // same expressions as CollideSpike
+    SpikeShape s;
+    s.width = width;
+    s.height = height;
+    s.up = up;
+    s.halfHeight = height * 0.5f;
+    s.baseOffsetY = up ? 0.0f : height * 0.5f;
+    s.tipWidth = width * 0.32f;
+    s.tipHeight = height * 0.72f;
+    s.tipOffsetX = (width - s.tipWidth) * 0.5f;
+    // up: y - tipHeight + height; down: y (minus and plus zero are exact)
+    s.tipDropY = up ? s.tipHeight : 0.0f;
+    s.tipRiseY = up ? height : 0.0f;
+    return s;
+}
+
+void PadPackedSpikes(PackedSpikes& spikes) {
+    // A block that starts on the last spike still reads kSpikeLanes values;
+    // the extra lanes are masked off by the kernels.
+    spikes.x.resize(spikes.color.size() + kSpikeLanes - 1, 0);
+    spikes.y.resize(spikes.color.size() + kSpikeLanes - 1, 0);
+}
+
+// -------------------------
+// Kernels
+// -------------------------
+// Box overlap is RectsIntersect written on corners:
+//   pMaxX > minX && maxX > pMinX && pMaxY > minY && maxY > pMinY
+// -------------------------
+
+static SpikeArrays ArraysOf(const PackedSpikes& spikes) {
+    return { spikes.shapes.data(), spikes.x.data(), spikes.y.data(), spikes.runs.data() };
+}
+
+static int FirstSpikeHitScalar(const SpikeArrays& spikes, int firstRun, int runCount, float originX, const Rectangle& player) {
+    float pMinX = player.x, pMaxX = player.x + player.width;
+    float pMinY = player.y, pMaxY = player.y + player.height;
+    for (int r = firstRun; r < firstRun + runCount; ++r) {
+        const SpikeRun& run = spikes.runs[r];
+        const SpikeShape& s = spikes.shapes[run.shape];
+        if (!RunNearPlayer(run, s, originX, pMinX, pMaxX)) continue;
+        for (int i = run.first; i < run.first + run.count; ++i) {
+            float x = originX + spikes.x[i] * kCoordStep;
+            float y = spikes.y[i] * kCoordStep;
+            float baseMinY = y + s.baseOffsetY;
+            float tipMinX = x + s.tipOffsetX;
+            float tipMinY = (y - s.tipDropY) + s.tipRiseY;
+            bool base = pMaxX > x && x + s.width > pMinX &&
+                pMaxY > baseMinY && baseMinY + s.halfHeight > pMinY;
+            bool tip = pMaxX > tipMinX && tipMinX + s.tipWidth > pMinX &&
+                pMaxY > tipMinY && tipMinY + s.tipHeight > pMinY;
+            if (base || tip) return i;
+        }
+    }
+    return -1;
+}
+
+int FirstSpikeHitScalar(const PackedSpikes& spikes, int firstRun, int runCount, float originX, const Rectangle& player) {
+    return FirstSpikeHitScalar(ArraysOf(spikes), firstRun, runCount, originX, player);
+}
+
+#if defined(SPIKE_KERNEL_SSE2)
+
+struct ShapeLanes {
+    __m128 width, halfHeight, baseOffsetY, tipWidth, tipHeight, tipOffsetX, tipDropY, tipRiseY;
+};
+
+struct PlayerLanes {
+    __m128 minX, maxX, minY, maxY;
+};
+
+// SSE2 has no 16-to-32 bit widening; interleave with itself and shift the sign in
+static inline __m128i WidenLo(__m128i v) { return _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16); }
+static inline __m128i WidenHi(__m128i v) { return _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16); }
+
+static inline __m128 Overlap4(__m128 x, __m128 y, const ShapeLanes& s, const PlayerLanes& p) {
+    __m128 baseMinY = _mm_add_ps(y, s.baseOffsetY);
+    __m128 tipMinX = _mm_add_ps(x, s.tipOffsetX);
+    __m128 tipMinY = _mm_add_ps(_mm_sub_ps(y, s.tipDropY), s.tipRiseY);
+    __m128 base = _mm_and_ps(
+        _mm_and_ps(_mm_cmpgt_ps(p.maxX, x), _mm_cmpgt_ps(_mm_add_ps(x, s.width), p.minX)),
+        _mm_and_ps(_mm_cmpgt_ps(p.maxY, baseMinY), _mm_cmpgt_ps(_mm_add_ps(baseMinY, s.halfHeight), p.minY)));
+    __m128 tip = _mm_and_ps(
+        _mm_and_ps(_mm_cmpgt_ps(p.maxX, tipMinX), _mm_cmpgt_ps(_mm_add_ps(tipMinX, s.tipWidth), p.minX)),
+        _mm_and_ps(_mm_cmpgt_ps(p.maxY, tipMinY), _mm_cmpgt_ps(_mm_add_ps(tipMinY, s.tipHeight), p.minY)));
+    return _mm_or_ps(base, tip);
+}
+
+static int FirstSpikeHitSse2(const SpikeArrays& spikes, int firstRun, int runCount, float originX, const Rectangle& player) {
+    PlayerLanes p;
+    p.minX = _mm_set1_ps(player.x);
+    p.maxX = _mm_set1_ps(player.x + player.width);
+    p.minY = _mm_set1_ps(player.y);
+    p.maxY = _mm_set1_ps(player.y + player.height);
+    const __m128 origin = _mm_set1_ps(originX);
+    const __m128 step = _mm_set1_ps(kCoordStep);
+
+    for (int r = firstRun; r < firstRun + runCount; ++r) {
+        const SpikeRun& run = spikes.runs[r];
+        const SpikeShape& shape = spikes.shapes[run.shape];
+        if (!RunNearPlayer(run, shape, originX, player.x, player.x + player.width)) continue;
+        ShapeLanes s;
+        s.width = _mm_set1_ps(shape.width);
+        s.halfHeight = _mm_set1_ps(shape.halfHeight);
+        s.baseOffsetY = _mm_set1_ps(shape.baseOffsetY);
+        s.tipWidth = _mm_set1_ps(shape.tipWidth);
+        s.tipHeight = _mm_set1_ps(shape.tipHeight);
+        s.tipOffsetX = _mm_set1_ps(shape.tipOffsetX);
+        s.tipDropY = _mm_set1_ps(shape.tipDropY);
+        s.tipRiseY = _mm_set1_ps(shape.tipRiseY);
+
+        // Two 4-wide halves per iteration, so SSE walks the same 8-lane blocks
+        int end = run.first + run.count;
+        for (int i = run.first; i < end; i += kSpikeLanes) {
+            __m128i qx = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&spikes.x[i]));
+            __m128i qy = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&spikes.y[i]));
+            __m128 xLo = _mm_add_ps(origin, _mm_mul_ps(_mm_cvtepi32_ps(WidenLo(qx)), step));
+            __m128 xHi = _mm_add_ps(origin, _mm_mul_ps(_mm_cvtepi32_ps(WidenHi(qx)), step));
+            __m128 yLo = _mm_mul_ps(_mm_cvtepi32_ps(WidenLo(qy)), step);
+            __m128 yHi = _mm_mul_ps(_mm_cvtepi32_ps(WidenHi(qy)), step);
+
+            int lo = _mm_movemask_ps(Overlap4(xLo, yLo, s, p));
+            int hi = _mm_movemask_ps(Overlap4(xHi, yHi, s, p));
+            int mask = (lo | (hi << 4)) & LaneMask(end - i);
+            if (mask) return i + LowestBit((unsigned int)mask);
+        }
+    }
+    return -1;
+}
+
+#endif
+
+// -------------------------
+// Float hulls
+// -------------------------
+
+void BuildFloatHulls(FloatHulls& hulls, const vector<Spike>& spikes) {
+    int padded = ((int)spikes.size() + kSpikeLanes - 1) / kSpikeLanes * kSpikeLanes;
+
+    // Empty boxes (min above max) never overlap anything
+    const float inf = numeric_limits<float>::infinity();
+    hulls.baseMinX.assign(padded, inf);
+    hulls.baseMinY.assign(padded, inf);
+    hulls.baseMaxX.assign(padded, -inf);
+    hulls.baseMaxY.assign(padded, -inf);
+    hulls.tipMinX.assign(padded, inf);
+    hulls.tipMinY.assign(padded, inf);
+    hulls.tipMaxX.assign(padded, -inf);
+    hulls.tipMaxY.assign(padded, -inf);
+
+    for (int i = 0; i < (int)spikes.size(); ++i) {
+        const Spike& s = spikes[i];
+
+        // same expressions as CollideSpike
+        float tipHeight = s.base.height * 0.72f;
+        float tipWidth = s.base.width * 0.32f;
+        Rectangle baseDanger = s.base;
+        baseDanger.height *= 0.5f;
+        if (!s.up) baseDanger.y = s.base.y + s.base.height * 0.5f;
+
+        Rectangle tipBox;
+        tipBox.width = tipWidth;
+        tipBox.height = tipHeight;
+        tipBox.x = s.base.x + (s.base.width - tipWidth) * 0.5f;
+        tipBox.y = s.up ? (s.base.y - tipHeight + s.base.height) : s.base.y;
+
+        hulls.baseMinX[i] = baseDanger.x;
+        hulls.baseMinY[i] = baseDanger.y;
+        hulls.baseMaxX[i] = baseDanger.x + baseDanger.width;
+        hulls.baseMaxY[i] = baseDanger.y + baseDanger.height;
+        hulls.tipMinX[i] = tipBox.x;
+        hulls.tipMinY[i] = tipBox.y;
+        hulls.tipMaxX[i] = tipBox.x + tipBox.width;
+        hulls.tipMaxY[i] = tipBox.y + tipBox.height;
+    }
+}
+
+static HullArrays ArraysOf(const FloatHulls& h) {
+    return { h.baseMinX.data(), h.baseMinY.data(), h.baseMaxX.data(), h.baseMaxY.data(),
+        h.tipMinX.data(), h.tipMinY.data(), h.tipMaxX.data(), h.tipMaxY.data(), (int)h.baseMinX.size() };
+}
+
+static int FirstFloatHullHitScalar(const HullArrays& h, const Rectangle& player) {
+    float pMinX = player.x, pMaxX = player.x + player.width;
+    float pMinY = player.y, pMaxY = player.y + player.height;
+    for (int i = 0; i < h.count; ++i) {
+        bool base = pMaxX > h.baseMinX[i] && h.baseMaxX[i] > pMinX &&
+            pMaxY > h.baseMinY[i] && h.baseMaxY[i] > pMinY;
+        bool tip = pMaxX > h.tipMinX[i] && h.tipMaxX[i] > pMinX &&
+            pMaxY > h.tipMinY[i] && h.tipMaxY[i] > pMinY;
+        if (base || tip) return i;
+    }
+    return -1;
+}
+
+#if defined(SPIKE_KERNEL_SSE2)
+
+static inline __m128 HullOverlap4(const HullArrays& h, int i, const PlayerLanes& p) {
+    __m128 base = _mm_and_ps(
+        _mm_and_ps(_mm_cmpgt_ps(p.maxX, _mm_loadu_ps(h.baseMinX + i)), _mm_cmpgt_ps(_mm_loadu_ps(h.baseMaxX + i), p.minX)),
+        _mm_and_ps(_mm_cmpgt_ps(p.maxY, _mm_loadu_ps(h.baseMinY + i)), _mm_cmpgt_ps(_mm_loadu_ps(h.baseMaxY + i), p.minY)));
+    __m128 tip = _mm_and_ps(
+        _mm_and_ps(_mm_cmpgt_ps(p.maxX, _mm_loadu_ps(h.tipMinX + i)), _mm_cmpgt_ps(_mm_loadu_ps(h.tipMaxX + i), p.minX)),
+        _mm_and_ps(_mm_cmpgt_ps(p.maxY, _mm_loadu_ps(h.tipMinY + i)), _mm_cmpgt_ps(_mm_loadu_ps(h.tipMaxY + i), p.minY)));
+    return _mm_or_ps(base, tip);
+}
+
+static int FirstFloatHullHitSse2(const HullArrays& h, const Rectangle& player) {
+    PlayerLanes p;
+    p.minX = _mm_set1_ps(player.x);
+    p.maxX = _mm_set1_ps(player.x + player.width);
+    p.minY = _mm_set1_ps(player.y);
+    p.maxY = _mm_set1_ps(player.y + player.height);
+
+    for (int i = 0; i < h.count; i += kSpikeLanes) {
+        int lo = _mm_movemask_ps(HullOverlap4(h, i, p));
+        int hi = _mm_movemask_ps(HullOverlap4(h, i + 4, p));
+        int mask = lo | (hi << 4);
+        if (mask) return i + LowestBit((unsigned int)mask);
+    }
+    return -1;
+}
+
+#endif
+
+// -------------------------
+// Dispatch
+// -------------------------
+// The widest kernels the CPU runs, picked once before main: AVX2 where the
+// CPU and OS support it, else SSE2 (every x64 CPU), else scalar.
+// -------------------------
+
+typedef int (*SpikeKernelFn)(const SpikeArrays&, int, int, float, const Rectangle&);
+typedef int (*HullKernelFn)(const HullArrays&, const Rectangle&);
+
+struct SpikeKernel {
+    SpikeKernelFn hit;
+    HullKernelFn hullHit;
+    const char* name;
+};
+
+#if defined(SPIKE_KERNEL_X86)
+static bool CpuHasAvx2() {
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    // The OS must save the YMM registers on a context switch
+    if (!osxsave || !avx || (_xgetbv(0) & 6) != 6) return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
+
+static SpikeKernel SelectSpikeKernel() {
+#if defined(SPIKE_KERNEL_X86)
+    if (CpuHasAvx2()) return { FirstSpikeHitAvx2, FirstFloatHullHitAvx2, "avx2" };
+#endif
+#if defined(SPIKE_KERNEL_SSE2)
+    return { FirstSpikeHitSse2, FirstFloatHullHitSse2, "sse2" };
+#else
+    return { FirstSpikeHitScalar, FirstFloatHullHitScalar, "scalar" };
+#endif
+}
+
+static const SpikeKernel gSpikeKernel = SelectSpikeKernel();
+
+int FirstSpikeHit(const PackedSpikes& spikes, int firstRun, int runCount, float originX, const Rectangle& player) {
+    return gSpikeKernel.hit(ArraysOf(spikes), firstRun, runCount, originX, player);
+}
+
+int FirstFloatHullHit(const FloatHulls& hulls, const Rectangle& player) {
+    return gSpikeKernel.hullHit(ArraysOf(hulls), player);
+}
+
+const char* SpikeKernelName() { return gSpikeKernel.name; }
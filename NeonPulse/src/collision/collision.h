@@ -0,0 +1,96 @@
+#pragma once
+#include "raylib.h"
+#include <cstdint>
+#include <vector>
+#include "../entities/entities.h"
+
+// -------------------------
+// Packed spikes
+// -------------------------
+// Spikes are stored in a compact form: positions are 16-bit fixed point
+// (x from the owning chunk's left edge, y absolute), sizes come from a
+// shared table of shapes, and colors are palette indices. Spikes built
+// from clusters share their shape, so a chunk is a few runs of
+// same-shaped spikes and two int16 per spike.
+//
+// CollideSpike derives two boxes from every spike: half of its box (the
+// top half for up spikes, the bottom half for down ones; see baseOffsetY)
+// and a narrow tip box. The kernels decode 8 positions at a time and
+// build those boxes from the run's shape with the same expressions, then
+// compare with the same strict inequalities as RectsIntersect, so every
+// path returns exactly what CollideSpike on the decoded spikes would.
+// -------------------------
+
+const int kSpikeLanes = 8;
+
+// Position quantum; int16 coordinates reach +-4096 px
+const float kCoordStep = 0.125f;
+
+int16_t QuantizeCoord(float v, bool* clamped = nullptr);
+
+struct SpikeShape {
+    float width;
+    float height;
+    bool up;
+
+    // Hull offsets, derived by MakeSpikeShape. Boxes for a spike at (x, y):
+    //   base: x .. x + width,              y + baseOffsetY .. + halfHeight
+    //   tip:  x + tipOffsetX .. + tipWidth, (y - tipDropY) + tipRiseY .. + tipHeight
+    float halfHeight;
+    float baseOffsetY;
+    float tipWidth;
+    float tipHeight;
+    float tipOffsetX;
+    float tipDropY;
+    float tipRiseY;
+};
+
+SpikeShape MakeSpikeShape(float width, float height, bool up);
+
+// Consecutive spikes sharing a shape
+struct SpikeRun {
+    int first; // into PackedSpikes::x / y / color
+    int count;
+    int shape; // into PackedSpikes::shapes
+    int16_t minX, maxX; // leftmost and rightmost spike x; runs nowhere near the player are skipped
+};
+
+// Spike storage, possibly shared by many chunks: a chunk owns a range of
+// runs, and positions are relative to that chunk's origin.
+struct PackedSpikes {
+    std::vector<SpikeShape> shapes;
+    std::vector<int16_t> x, y;   // kCoordStep units; padded so the kernels can read a full block
+    std::vector<uint8_t> color;  // palette index
+    std::vector<SpikeRun> runs;
+};
+
+// Pads the coordinate arrays; call once after the last spike is added.
+void PadPackedSpikes(PackedSpikes& spikes);
+
+inline float PackedSpikeX(const PackedSpikes& spikes, float originX, int i) { return originX + spikes.x[i] * kCoordStep; }
+inline float PackedSpikeY(const PackedSpikes& spikes, int i) { return spikes.y[i] * kCoordStep; }
+
+// Index of the first spike of runs [firstRun, firstRun + runCount) touching
+// the player, or -1. FirstSpikeHit uses the widest kernel the CPU runs
+// (AVX2, SSE2, else scalar), checked once at startup.
+int FirstSpikeHit(const PackedSpikes& spikes, int firstRun, int runCount, float originX, const Rectangle& player);
+int FirstSpikeHitScalar(const PackedSpikes& spikes, int firstRun, int runCount, float originX, const Rectangle& player);
+const char* SpikeKernelName();
+
+// -------------------------
+// Float hulls
+// -------------------------
+// The per-chunk spike layout the packed form replaced: both boxes of every
+// spike as float corners, padded to kSpikeLanes with empty boxes. Nothing
+// in the game reads it; it is the reference the memory benchmark times the
+// packed kernels against, with the same kernel selection.
+// -------------------------
+
+struct FloatHulls {
+    std::vector<float> baseMinX, baseMinY, baseMaxX, baseMaxY;
+    std::vector<float> tipMinX, tipMinY, tipMaxX, tipMaxY;
+};
+
+void BuildFloatHulls(FloatHulls& hulls, const std::vector<Spike>& spikes);
+// Index of the first spike touching the player, or -1
+int FirstFloatHullHit(const FloatHulls& hulls, const Rectangle& player);
@@ -0,0 +1,90 @@
+#include "kernels.h"
+
+// Built for AVX2 on its own (see kernels.h): MSVC through the file's
+// /arch:AVX2, GCC and Clang through the target attribute, so no AVX2
+// instruction leaks into code that runs before the CPU check.
+
+#if defined(SPIKE_KERNEL_X86)
+#include <immintrin.h>
+
+#if defined(__GNUC__)
+#define SPIKE_AVX2_TARGET __attribute__((target("avx2")))
+#else
+#define SPIKE_AVX2_TARGET
+#endif
+
+SPIKE_AVX2_TARGET
+int FirstSpikeHitAvx2(const SpikeArrays& spikes, int firstRun, int runCount, float originX, const Rectangle& player) {
+    const __m256 pMinX = _mm256_set1_ps(player.x);
+    const __m256 pMaxX = _mm256_set1_ps(player.x + player.width);
+    const __m256 pMinY = _mm256_set1_ps(player.y);
+    const __m256 pMaxY = _mm256_set1_ps(player.y + player.height);
+    const __m256 origin = _mm256_set1_ps(originX);
+    const __m256 step = _mm256_set1_ps(kCoordStep);
+
+    for (int r = firstRun; r < firstRun + runCount; ++r) {
+        const SpikeRun& run = spikes.runs[r];
+        const SpikeShape& s = spikes.shapes[run.shape];
+        if (!RunNearPlayer(run, s, originX, player.x, player.x + player.width)) continue;
+        const __m256 width = _mm256_set1_ps(s.width);
+        const __m256 halfHeight = _mm256_set1_ps(s.halfHeight);
+        const __m256 baseOffsetY = _mm256_set1_ps(s.baseOffsetY);
+        const __m256 tipWidth = _mm256_set1_ps(s.tipWidth);
+        const __m256 tipHeight = _mm256_set1_ps(s.tipHeight);
+        const __m256 tipOffsetX = _mm256_set1_ps(s.tipOffsetX);
+        const __m256 tipDropY = _mm256_set1_ps(s.tipDropY);
+        const __m256 tipRiseY = _mm256_set1_ps(s.tipRiseY);
+
+        int end = run.first + run.count;
+        for (int i = run.first; i < end; i += kSpikeLanes) {
+            __m256i qx = _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&spikes.x[i])));
+            __m256i qy = _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&spikes.y[i])));
+            __m256 x = _mm256_add_ps(origin, _mm256_mul_ps(_mm256_cvtepi32_ps(qx), step));
+            __m256 y = _mm256_mul_ps(_mm256_cvtepi32_ps(qy), step);
+
+            __m256 baseMinY = _mm256_add_ps(y, baseOffsetY);
+            __m256 tipMinX = _mm256_add_ps(x, tipOffsetX);
+            __m256 tipMinY = _mm256_add_ps(_mm256_sub_ps(y, tipDropY), tipRiseY);
+
+            __m256 base = _mm256_and_ps(
+                _mm256_and_ps(_mm256_cmp_ps(pMaxX, x, _CMP_GT_OQ),
+                    _mm256_cmp_ps(_mm256_add_ps(x, width), pMinX, _CMP_GT_OQ)),
+                _mm256_and_ps(_mm256_cmp_ps(pMaxY, baseMinY, _CMP_GT_OQ),
+                    _mm256_cmp_ps(_mm256_add_ps(baseMinY, halfHeight), pMinY, _CMP_GT_OQ)));
+            __m256 tip = _mm256_and_ps(
+                _mm256_and_ps(_mm256_cmp_ps(pMaxX, tipMinX, _CMP_GT_OQ),
+                    _mm256_cmp_ps(_mm256_add_ps(tipMinX, tipWidth), pMinX, _CMP_GT_OQ)),
+                _mm256_and_ps(_mm256_cmp_ps(pMaxY, tipMinY, _CMP_GT_OQ),
+                    _mm256_cmp_ps(_mm256_add_ps(tipMinY, tipHeight), pMinY, _CMP_GT_OQ)));
+            int mask = _mm256_movemask_ps(_mm256_or_ps(base, tip)) & LaneMask(end - i);
+            if (mask) return i + LowestBit((unsigned int)mask);
+        }
+    }
+    return -1;
+}
+
+SPIKE_AVX2_TARGET
+int FirstFloatHullHitAvx2(const HullArrays& hulls, const Rectangle& player) {
+    const __m256 pMinX = _mm256_set1_ps(player.x);
+    const __m256 pMaxX = _mm256_set1_ps(player.x + player.width);
+    const __m256 pMinY = _mm256_set1_ps(player.y);
+    const __m256 pMaxY = _mm256_set1_ps(player.y + player.height);
+
+    for (int i = 0; i < hulls.count; i += kSpikeLanes) {
+        __m256 base = _mm256_and_ps(
+            _mm256_and_ps(_mm256_cmp_ps(pMaxX, _mm256_loadu_ps(hulls.baseMinX + i), _CMP_GT_OQ),
+                _mm256_cmp_ps(_mm256_loadu_ps(hulls.baseMaxX + i), pMinX, _CMP_GT_OQ)),
+            _mm256_and_ps(_mm256_cmp_ps(pMaxY, _mm256_loadu_ps(hulls.baseMinY + i), _CMP_GT_OQ),
+                _mm256_cmp_ps(_mm256_loadu_ps(hulls.baseMaxY + i), pMinY, _CMP_GT_OQ)));
+        __m256 tip = _mm256_and_ps(
+            _mm256_and_ps(_mm256_cmp_ps(pMaxX, _mm256_loadu_ps(hulls.tipMinX + i), _CMP_GT_OQ),
+                _mm256_cmp_ps(_mm256_loadu_ps(hulls.tipMaxX + i), pMinX, _CMP_GT_OQ)),
+            _mm256_and_ps(_mm256_cmp_ps(pMaxY, _mm256_loadu_ps(hulls.tipMinY + i), _CMP_GT_OQ),
+                _mm256_cmp_ps(_mm256_loadu_ps(hulls.tipMaxY + i), pMinY, _CMP_GT_OQ)));
+        int mask = _mm256_movemask_ps(_mm256_or_ps(base, tip));
+        if (mask) return i + LowestBit((unsigned int)mask);
+    }
+    return -1;
+}
+
+#endif
@@ -0,0 +1,69 @@
+#pragma once
+#include "collision.h"
+
+// -------------------------
+// Spike kernel internals
+// -------------------------
+// Shared by the kernel translation units of collision/; not for use
+// elsewhere. The AVX2 kernel lives in collision_avx2.cpp, the only file
+// built for AVX2 (/arch:AVX2, or a target attribute on GCC/Clang), and
+// collision.cpp only calls it after checking the CPU at startup.
+// -------------------------
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define SPIKE_KERNEL_X86
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// Every box of a spike lies within x .. x + width, so a run whose span
+// misses the player cannot hit it
+static inline bool RunNearPlayer(const SpikeRun& run, const SpikeShape& s, float originX, float pMinX, float pMaxX) {
+    float left = originX + run.minX * kCoordStep;
+    float right = (originX + run.maxX * kCoordStep) + s.width;
+    return pMaxX > left && right > pMinX;
+}
+
+static inline int LowestBit(unsigned int mask) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return (int)index;
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+
+// Lanes of a block that belong to the run
+static inline int LaneMask(int remaining) {
+    return remaining >= kSpikeLanes ? (1 << kSpikeLanes) - 1 : (1 << remaining) - 1;
+}
+
+// What the kernels read, as plain arrays. The AVX2 file must not
+// instantiate inline functions other files share (std::vector members
+// included), or the linker may keep its AVX2 copy for all of them.
+struct SpikeArrays {
+    const SpikeShape* shapes;
+    const int16_t* x;
+    const int16_t* y;
+    const SpikeRun* runs;
+};
+
+struct HullArrays {
+    const float* baseMinX;
+    const float* baseMinY;
+    const float* baseMaxX;
+    const float* baseMaxY;
+    const float* tipMinX;
+    const float* tipMinY;
+    const float* tipMaxX;
+    const float* tipMaxY;
+    int count; // a multiple of kSpikeLanes
+};
+
+#if defined(SPIKE_KERNEL_X86)
+int FirstSpikeHitAvx2(const SpikeArrays& spikes, int firstRun, int runCount, float originX, const Rectangle& player);
+int FirstFloatHullHitAvx2(const HullArrays& hulls, const Rectangle& player);
+#endif
@@ -1,5 +1,6 @@
 #include "entities.h"
 #include "../utils/utils.h"
+#include "../profiler/profiler.h"
 #include "raymath.h"
 #include <cmath>
 
@@ -42,6 +43,7 @@ bool CollideSpike(const Rectangle& player, const Spike& s) {
 // Draw a spike (either pointing up from the floor, or pointing down from the ceiling)
 void DrawSpike(const Spike& s, float camX) {
     BeginBlendMode(BLEND_ALPHA);
+    CountBlendChange();
 
     Vector2 leftBase, rightBase, tip;
 
@@ -64,10 +66,21 @@ void DrawSpike(const Spike& s, float camX) {
 
     // Draw filled triangle
     DrawTriangle(leftBase, rightBase, tip, fillColor);
+    CountDraw(RENDER_SPIKES, kVertsTriangle);
 
     // Draw outline for better visibility
     DrawTriangleLines(leftBase, rightBase, tip, outlineColor);
+    CountDraw(RENDER_SPIKES, kVertsTriangleLines);
 
     EndBlendMode();
+    CountBlendChange();
 }
 
+
+// -------------------------
+// Particles
+// -------------------------
+
+void SpawnParticle(std::vector<Particle>& particles, const Particle& p) {
+    if (particles.size() < particles.capacity()) particles.push_back(p);
+}
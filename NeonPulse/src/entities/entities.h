@@ -64,9 +64,20 @@ struct SpeedPad {
     Color color;
 };
 
+struct GravityPad {
+    Rectangle rect;
+    Color color;
+    bool flipsUp;
+};
+
 // -------------------------
 // Functions
 // -------------------------
 
 bool CollideSpike(const Rectangle& player, const Spike& s);
 void DrawSpike(const Spike& s, float camX);
+
+// Particles live in a vector reserved to kMaxParticles once; spawns past
+// that capacity are dropped instead of growing the buffer mid-game.
+const int kMaxParticles = 512;
+void SpawnParticle(std::vector<Particle>& particles, const Particle& p);
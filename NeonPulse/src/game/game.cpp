@@ -0,0 +1,291 @@
+#include "game.h"
+#include "../utils/utils.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+// -------------------------
+// Tuning
+// -------------------------
+
+static const float baseRunSpeedDefault = 420.0f;
+static const float gravityBase = 2300.0f;
+static const float jumpVelBase = -760.0f; // base jump velocity; multiply by gravityDir for effective jump
+static const float gravityFlipCooldown = 0.35f; // seconds
+
+// -------------------------
+// State
+// -------------------------
+
+void ResetGame(GameState& state) {
+    state.songTime = 0.0f;
+    state.player = { 100, 520, 36, 36 };
+    state.playerVel = { 0.0f, 0.0f };
+    state.baseRunSpeed = baseRunSpeedDefault;
+    state.runSpeed = baseRunSpeedDefault;
+    state.grounded = false;
+    state.alive = true;
+    state.deathShake = 0.0f;
+
+    // reset auto-jump flags
+    state.holdJumpActive = false;
+    state.prevGrounded = false;
+
+    // reset gravity state on restart
+    state.gravityDir = 1;            // restore normal gravity
+    state.gravityFlipTimer = 0.0f;   // clear any flip cooldown
+    state.levelFinished = false;
+
+    state.speedTimer = 0.0f;
+    state.speedMultiplierActive = 1.0f;
+}
+
+float BeatPulse(float t) {
+    float beat = fmodf(t, secondsPerBeat);
+    return expf(-6.0f * beat);
+}
+
+// -------------------------
+// Step
+// -------------------------
+
+void StepGame(GameState& state, const Level& level, const StepInput& input, float dt, GameEvents& events) {
+    Rectangle& player = state.player;
+    Vector2& playerVel = state.playerVel;
+    int& gravityDir = state.gravityDir;
+
+    // Restart if dead
+    if (input.restart && (!state.alive || state.levelFinished)) {
+        ResetGame(state);
+        events.Push(GAME_EVENT_RESTART, player, neonCyan);
+    }
+
+    state.songTime += dt;
+
+    // Input: jump
+    if (state.alive) {
+        // Update the holding state
+        state.holdJumpActive = input.jumpHeld;
+
+        // Immediate single jump on key press (preserves original tap behavior)
+        if (input.jumpPressed && state.grounded) {
+            events.Push(GAME_EVENT_JUMP, player, neonYellow);
+            playerVel.y = jumpVelBase * (float)gravityDir;
+            state.grounded = false;
+        }
+    }
+
+    // reset base runSpeed if no active speedpad
+    if (state.speedTimer <= 0.0f) {
+        state.speedMultiplierActive = 1.0f;
+        state.runSpeed = state.baseRunSpeed;
+    }
+    else {
+        state.speedTimer -= dt;
+        if (state.speedTimer <= 0.0f) {
+            state.speedTimer = 0.0f;
+            state.speedMultiplierActive = 1.0f;
+            state.runSpeed = state.baseRunSpeed;
+        }
+        else {
+            state.runSpeed = state.baseRunSpeed * state.speedMultiplierActive;
+        }
+    }
+
+    // gravity flip cooldown decrement
+    if (state.gravityFlipTimer > 0.0f) state.gravityFlipTimer = max(0.0f, state.gravityFlipTimer - dt);
+
+    // player horizontal control (auto-run)
+    if (state.alive) playerVel.x = state.runSpeed;
+    else playerVel.x = 0.0f;
+    if (state.levelFinished) playerVel.x = 0.0f;
+
+    // gravity
+    playerVel.y += gravityBase * (float)gravityDir * dt;
+
+    // integrate
+    if (state.alive) {
+        player.x += playerVel.x * dt;
+        player.y += playerVel.y * dt;
+    }
+
+    // Floor / ceiling collision handling with gravity direction awareness
+    state.grounded = false;
+    if (gravityDir > 0) {
+        // normal gravity: floor is defaultFloorY, ceiling is ceilingYTop
+        if (player.y + player.height >= defaultFloorY) {
+            player.y = defaultFloorY - player.height;
+            playerVel.y = 0.0f;
+            state.grounded = true;
+        }
+        if (player.y <= ceilingYTop) {
+            player.y = ceilingYTop;
+            if (playerVel.y < 0.0f) playerVel.y = 0.0f;
+        }
+    }
+    else {
+        // inverted gravity
+        if (player.y <= ceilingYTop) {
+            player.y = ceilingYTop;
+            playerVel.y = 0.0f;
+            state.grounded = true;
+        }
+        if (player.y + player.height >= defaultFloorY) {
+            player.y = defaultFloorY - player.height;
+            if (playerVel.y > 0.0f) playerVel.y = 0.0f;
+        }
+    }
+
+    // Moving platforms collision + resolve
+    float pulse = BeatPulse(state.songTime);
+    float tPhase = state.songTime + pulse * 0.03f;
+    ChunkSpan near = ChunksOverlapping(level.grid, player.x - 300.0f, player.x + 900.0f);
+    for (int c = near.first; c <= near.last; ++c) for (const auto& p : Items(level.grid.platforms, level.grid.chunks[c].platforms)) {
+        Rectangle pr = p.GetRect(tPhase);
+        if (pr.x + pr.width < player.x - 300.0f || pr.x > player.x + 900.0f) continue; // cull
+        if (RectsIntersect(player, pr)) {
+            Rectangle prevPlayer = { player.x - playerVel.x * dt, player.y - playerVel.y * dt, player.width, player.height };
+
+            // Determine contact sides based on previous position
+            bool fromTop = (prevPlayer.y + prevPlayer.height <= pr.y + 1.0f);
+            bool fromBottom = (prevPlayer.y >= pr.y + pr.height - 1.0f);
+            bool fromLeft = (prevPlayer.x + prevPlayer.width <= pr.x + 1.0f);
+            bool fromRight = (prevPlayer.x >= pr.x + pr.width - 1.0f);
+
+            if (gravityDir > 0) {
+                // normal gravity: landing is fromTop
+                if (fromTop) {
+                    player.y = pr.y - player.height;
+                    playerVel.y = 0.0f;
+                    state.grounded = true;
+                    if (!p.vertical) {
+                        float angularFreq = p.speed * 2.0f * PI;
+                        float platformVel = cosf(p.phase + tPhase * p.speed * 2.0f * PI) * p.amplitude * angularFreq;
+                        player.x += platformVel * dt * 0.08f;
+                    }
+                }
+                else if (fromBottom) {
+                    player.y = pr.y + pr.height;
+                    playerVel.y = 0.0f;
+                }
+                else if (fromLeft) {
+                    player.x = pr.x - player.width;
+                }
+                else if (fromRight) {
+                    player.x = pr.x + pr.width;
+                }
+            }
+            else {
+                // inverted gravity: landing occurs fromBottom
+                if (fromBottom) {
+                    player.y = pr.y + pr.height;
+                    playerVel.y = 0.0f;
+                    state.grounded = true;
+                    if (!p.vertical) {
+                        float angularFreq = p.speed * 2.0f * PI;
+                        float platformVel = cosf(p.phase + tPhase * p.speed * 2.0f * PI) * p.amplitude * angularFreq;
+                        player.x += platformVel * dt * 0.08f;
+                    }
+                }
+                else if (fromTop) {
+                    player.y = pr.y - player.height;
+                    playerVel.y = 0.0f;
+                }
+                else if (fromLeft) {
+                    player.x = pr.x - player.width;
+                }
+                else if (fromRight) {
+                    player.x = pr.x + pr.width;
+                }
+            }
+        }
+    }
+
+    // Pads only need the chunks under the player
+    ChunkSpan under = ChunksOverlapping(level.grid, player.x, player.x + player.width);
+
+    // JumpPad activation
+    for (int c = under.first; c <= under.last; ++c) for (const auto& jp : Items(level.grid.jumpPads, level.grid.chunks[c].jumpPads)) {
+        if (RectsIntersect(player, UnpackRect(level.grid, level.grid.chunks[c], jp.rect))) {
+            playerVel.y = jumpVelBase * gravityDir * jp.strength; // immediately boost up
+            state.grounded = false;
+            events.Push(GAME_EVENT_JUMP_PAD, player, level.grid.palette[jp.color]);
+        }
+    }
+
+    // SpeedPad activation (instant apply multiplier)
+    for (int c = under.first; c <= under.last; ++c) for (const auto& sp : Items(level.grid.speedPads, level.grid.chunks[c].speedPads)) {
+        if (RectsIntersect(player, UnpackRect(level.grid, level.grid.chunks[c], sp.rect))) {
+            state.speedTimer = sp.duration;
+            state.speedMultiplierActive = sp.multiplier;
+            state.runSpeed = state.baseRunSpeed * state.speedMultiplierActive;
+            events.Push(GAME_EVENT_SPEED_PAD, player, level.grid.palette[sp.color]);
+        }
+    }
+
+    // GravityPad activation: flip gravity when touching a gravity pad
+    for (int c = under.first; c <= under.last; ++c) for (const auto& gp : Items(level.grid.gravityPads, level.grid.chunks[c].gravityPads)) {
+        if (RectsIntersect(player, UnpackRect(level.grid, level.grid.chunks[c], gp.rect)) && state.gravityFlipTimer <= 0.0f) {
+            // flip gravity
+            gravityDir = -gravityDir;
+            state.gravityFlipTimer = gravityFlipCooldown;
+
+            // reset vertical velocity for predictability
+            playerVel.y = 0.0f;
+
+            // - if gravity becomes inverted => force player to be on "ceiling" (grounded = true)
+            // - if gravity becomes normal => place player on floor
+            if (gravityDir < 0) {
+                // place player just below the ceiling so they land/stand on it
+                player.y = ceilingYTop + 0.5f; // small offset to avoid overlapping spike geometry
+            }
+            else {
+                // place player on floor
+                player.y = defaultFloorY - player.height - 0.5f;
+            }
+            state.grounded = true;
+            state.prevGrounded = true;
+
+            events.Push(GAME_EVENT_GRAVITY_FLIP, player, level.grid.palette[gp.color]);
+        }
+    }
+
+    // Finish line detection
+    if (state.alive && !state.levelFinished && RectsIntersect(player, level.finishLine)) {
+        state.levelFinished = true;
+
+        // Stop player movement
+        playerVel = { 0, 0 };
+        events.Push(GAME_EVENT_FINISHED, player, neonGreen);
+    }
+
+    // Spike collision = death
+    ChunkSpan spikeSpan = ChunksOverlapping(level.grid, player.x, player.x + player.width);
+    for (int c = spikeSpan.first; c <= spikeSpan.last; ++c) {
+        const LevelChunk& chunk = level.grid.chunks[c];
+        int hit = FirstSpikeHit(level.grid, chunk, player);
+        if (hit >= 0) {
+            if (state.alive) events.Push(GAME_EVENT_DIED, player, level.grid.palette[level.grid.spikes.color[hit]]);
+            state.alive = false;
+            state.deathShake = 8.0f;
+            break;
+        }
+    }
+
+    // Auto-jump on landing
+    if (state.alive) {
+        // Landing detection: prevGrounded == false && grounded == true
+        if (!state.prevGrounded && state.grounded && state.holdJumpActive) {
+            events.Push(GAME_EVENT_JUMP, player, neonYellow);
+            // immediate auto-jump
+            playerVel.y = jumpVelBase * (float)gravityDir;
+            state.grounded = false;
+        }
+    }
+
+    if (state.deathShake > 0.0f) state.deathShake = max(0.0f, state.deathShake - 24.0f * dt);
+
+    // update prevGrounded for the next step's landing detection
+    state.prevGrounded = state.grounded;
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include "raylib.h"
+#include "../level/level.h"
+
+// -------------------------
+// Gameplay simulation
+// -------------------------
+// Everything the run depends on lives in GameState and is advanced by
+// StepGame in fixed time steps. Side effects that only matter for
+// presentation (particles, telemetry) are reported back as GameEvents so
+// the caller decides what to do with them.
+// -------------------------
+
+// Rhythm
+const float BPM = 140.0f;
+const float secondsPerBeat = 60.0f / BPM;
+
+// Fixed simulation rate; several steps run per rendered frame
+const int kSimHz = 480;
+const float kSimStep = 1.0f / kSimHz;
+
+struct GameState {
+    float songTime;
+
+    // Player
+    Rectangle player;
+    Vector2 playerVel;
+    float baseRunSpeed;
+    float runSpeed;
+    bool grounded;
+    bool alive;
+    float deathShake;
+    bool holdJumpActive;
+    bool prevGrounded;
+    int gravityDir;          // 1 = normal (gravity pulls down), -1 = inverted (gravity pulls up)
+    float gravityFlipTimer;  // gravity flip cooldown (prevents immediate re-flip while overlapping a gravity pad)
+    bool levelFinished;
+
+    // SpeedPad state
+    float speedTimer;
+    float speedMultiplierActive;
+};
+
+struct StepInput {
+    bool jumpPressed; // a press lands in this step
+    bool jumpHeld;
+    bool restart;     // only acted on once the run is over (crashed or finished)
+};
+
+enum GameEventType {
+    GAME_EVENT_JUMP = 0,     // manual jump or auto-jump on landing
+    GAME_EVENT_JUMP_PAD,
+    GAME_EVENT_SPEED_PAD,
+    GAME_EVENT_GRAVITY_FLIP,
+    GAME_EVENT_FINISHED,
+    GAME_EVENT_DIED,
+    GAME_EVENT_RESTART,
+};
+
+struct GameEvent {
+    GameEventType type;
+    Rectangle player; // player rect at the moment of the event
+    Color color;      // color of the pad involved, if any
+};
+
+struct GameEvents {
+    static const int kCapacity = 16;
+    GameEvent items[kCapacity];
+    int count = 0;
+
+    void Push(GameEventType type, const Rectangle& player, Color color) {
+        if (count < kCapacity) items[count++] = { type, player, color };
+    }
+};
+
+void ResetGame(GameState& state);
+float BeatPulse(float songTime);
+void StepGame(GameState& state, const Level& level, const StepInput& input, float dt, GameEvents& events);
@@ -0,0 +1,263 @@
+#include "harness.h"
+#include "raylib.h"
+#include "../level/level.h"
+#include "../render/render.h"
+#include "../profiler/profiler.h"
+#include "../bloom/bloom.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#if defined(_WIN32)
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+using namespace std;
+
+// -------------------------
+// Scripted path
+// -------------------------
+
+static const int kScreenW = 1280;
+static const int kScreenH = 720;
+static const float kCamStep = 8.0f;          // world px per frame
+static const float kSecondsPerBeat = 60.0f / 140.0f;
+static const float kGoldenCamX[] = { 0.0f, 2400.0f, 3000.0f, 4704.0f, 5400.0f, 7104.0f, 8704.0f }; // multiples of kCamStep
+
+static void MakeDir(const string& path) {
+#if defined(_WIN32)
+    _mkdir(path.c_str());
+#else
+    mkdir(path.c_str(), 0755);
+#endif
+}
+
+// Deterministic particle trail behind the player so the particle path is exercised
+static void FillParticles(vector<Particle>& particles, const Rectangle& player, int frame) {
+    particles.clear();
+    unsigned int seed = 1234u + (unsigned int)frame;
+    for (int i = 0; i < 40; ++i) {
+        seed = seed * 1664525u + 1013904223u;
+        float jx = (float)((seed >> 8) % 100) / 100.0f;
+        float jy = (float)((seed >> 16) % 100) / 100.0f;
+        particles.push_back({
+            { player.x - 20.0f - jx * 120.0f, player.y + player.height - jy * 40.0f },
+            { 0.0f, 0.0f },
+            0.1f + 0.3f * jy,
+            2.0f + 4.0f * jx,
+            Fade(neonYellow, 0.9f)
+            });
+    }
+}
+
+// -------------------------
+// Golden images
+// -------------------------
+
+// Returns the fraction of pixels whose channels differ by more than a small threshold,
+// or a negative value when the sizes do not match.
+static float ImageDiff(Image a, Image b) {
+    if (a.width != b.width || a.height != b.height) return -1.0f;
+    Color* ca = LoadImageColors(a);
+    Color* cb = LoadImageColors(b);
+    int count = a.width * a.height;
+    int differing = 0;
+    for (int i = 0; i < count; ++i) {
+        int d = max(max(abs(ca[i].r - cb[i].r), abs(ca[i].g - cb[i].g)), abs(ca[i].b - cb[i].b));
+        if (d > 8) differing++;
+    }
+    UnloadImageColors(ca);
+    UnloadImageColors(cb);
+    return (float)differing / (float)count;
+}
+
+static bool CheckGolden(const HarnessOptions& options, RenderTexture2D target, float camX) {
+    Image frame = LoadImageFromTexture(target.texture);
+    ImageFlipVertical(&frame);
+
+    string path = options.dir + "/" + TextFormat("golden_%05d.png", (int)camX);
+    bool ok = true;
+    if (options.updateGolden || !FileExists(path.c_str())) {
+        ExportImage(frame, path.c_str());
+        printf("  golden  camX %6.0f  written %s\n", camX, path.c_str());
+    }
+    else {
+        Image golden = LoadImage(path.c_str());
+        float diff = ImageDiff(frame, golden);
+        ok = diff >= 0.0f && diff <= options.pixelTolerance;
+        printf("  golden  camX %6.0f  diff %6.3f%%  %s\n", camX, diff * 100.0f, ok ? "ok" : "FAIL");
+        if (!ok) ExportImage(frame, (options.dir + "/" + TextFormat("actual_%05d.png", (int)camX)).c_str());
+        UnloadImage(golden);
+    }
+    UnloadImage(frame);
+    return ok;
+}
+
+// -------------------------
+// Baseline
+// -------------------------
+// baseline.txt: one "<category> <drawCalls/frame> <vertices/frame>" line per
+// category, then "blend <changes/frame>" and "cpu_ms <avg>".
+// -------------------------
+
+struct HarnessTotals {
+    double drawCalls[RENDER_CATEGORY_COUNT] = {};
+    double vertices[RENDER_CATEGORY_COUNT] = {};
+    double blendChanges = 0.0;
+    double cpuMs = 0.0;
+};
+
+static void WriteBaseline(const string& path, const HarnessTotals& t) {
+    FILE* f = fopen(path.c_str(), "w");
+    if (!f) return;
+    for (int c = 0; c < RENDER_CATEGORY_COUNT; ++c) {
+        fprintf(f, "%s %.2f %.2f\n", RenderCategoryName((RenderCategory)c), t.drawCalls[c], t.vertices[c]);
+    }
+    fprintf(f, "blend %.2f\n", t.blendChanges);
+    fprintf(f, "cpu_ms %.4f\n", t.cpuMs);
+    fclose(f);
+}
+
+static bool ReadBaseline(const string& path, HarnessTotals& t) {
+    FILE* f = fopen(path.c_str(), "r");
+    if (!f) return false;
+    bool ok = true;
+    char name[32];
+    for (int c = 0; c < RENDER_CATEGORY_COUNT && ok; ++c) {
+        ok = fscanf(f, "%31s %lf %lf", name, &t.drawCalls[c], &t.vertices[c]) == 3;
+    }
+    ok = ok && fscanf(f, "%31s %lf", name, &t.blendChanges) == 2;
+    ok = ok && fscanf(f, "%31s %lf", name, &t.cpuMs) == 2;
+    fclose(f);
+    return ok;
+}
+
+// -------------------------
+// Harness
+// -------------------------
+
+int RunRenderHarness(const HarnessOptions& options) {
+    SetConfigFlags(FLAG_WINDOW_HIDDEN);
+    InitWindow(kScreenW, kScreenH, "Neon Pulse - render harness");
+    MakeDir(options.dir);
+
+    Level level;
+    BuildLevel(level, kScreenH);
+    RenderTexture2D world = LoadRenderTexture(kScreenW, kScreenH);
+    RenderTexture2D target = LoadRenderTexture(kScreenW, kScreenH);
+    Bloom bloom;
+    bloom.Init(kScreenW, kScreenH);
+
+    vector<Particle> particles;
+    particles.reserve(64);
+    vector<float> frameMs;
+    frameMs.reserve((size_t)(level.finishLine.x / kCamStep) + 64);
+
+    HarnessTotals totals;
+    int maxDrawCalls = 0;
+    bool imagesOk = true;
+    size_t nextGolden = 0;
+    const size_t goldenCount = sizeof(kGoldenCamX) / sizeof(kGoldenCamX[0]);
+    float endX = level.finishLine.x + 200.0f;
+
+    int frame = 0;
+    for (float camX = 0.0f; camX <= endX; camX += kCamStep, ++frame) {
+        float songTime = frame / 120.0f;
+        float pulse = expf(-6.0f * fmodf(songTime, kSecondsPerBeat));
+        Rectangle player = { camX + 280.0f, defaultFloorY - 36.0f - fabsf(sinf(camX * 0.01f)) * 120.0f, 36.0f, 36.0f };
+        FillParticles(particles, player, frame);
+
+        const Section& sec = CurrentSection(level, camX + kScreenW * 0.5f);
+        WorldView view = { kScreenW, kScreenH, camX, 0.0f, 0.0f, pulse, songTime, player, true, nullptr, nullptr, false };
+
+        ResetRenderStats();
+        double t0 = GetTime();
+        BeginTextureMode(world);
+        ClearBackground(BLACK);
+        DrawWorld(level, sec, particles, view);
+        EndTextureMode();
+
+        // Same post chain as the game: world + bloom, captured in target
+        Rectangle full = { 0.0f, 0.0f, (float)kScreenW, (float)-kScreenH };
+        bloom.Render(world.texture, full);
+        BeginTextureMode(target);
+        ClearBackground(BLACK);
+        DrawTextureRec(world.texture, full, { 0.0f, 0.0f }, WHITE);
+        bloom.Composite(pulse);
+        EndTextureMode();
+        float ms = (float)((GetTime() - t0) * 1000.0);
+
+        frameMs.push_back(ms);
+        for (int c = 0; c < RENDER_CATEGORY_COUNT; ++c) {
+            totals.drawCalls[c] += gRenderStats.categories[c].drawCalls;
+            totals.vertices[c] += gRenderStats.categories[c].vertices;
+        }
+        totals.blendChanges += gRenderStats.blendChanges;
+        totals.cpuMs += ms;
+        maxDrawCalls = max(maxDrawCalls, gRenderStats.TotalDrawCalls());
+
+        if (nextGolden < goldenCount && camX >= kGoldenCamX[nextGolden]) {
+            imagesOk = CheckGolden(options, target, camX) && imagesOk; // named after where it was captured
+            nextGolden++;
+        }
+    }
+
+    // per-frame averages
+    for (int c = 0; c < RENDER_CATEGORY_COUNT; ++c) {
+        totals.drawCalls[c] /= frame;
+        totals.vertices[c] /= frame;
+    }
+    totals.blendChanges /= frame;
+    totals.cpuMs /= frame;
+
+    sort(frameMs.begin(), frameMs.end());
+    float p95 = frameMs[(size_t)(frameMs.size() * 0.95f)];
+
+    printf("\nrender harness: %d frames, max %d draw calls/frame, cpu avg %.3fms p95 %.3fms\n",
+        frame, maxDrawCalls, totals.cpuMs, p95);
+    printf("  %-12s %10s %10s\n", "category", "calls/f", "verts/f");
+    for (int c = 0; c < RENDER_CATEGORY_COUNT; ++c) {
+        printf("  %-12s %10.1f %10.1f\n", RenderCategoryName((RenderCategory)c), totals.drawCalls[c], totals.vertices[c]);
+    }
+    printf("  %-12s %10.1f\n", "blend", totals.blendChanges);
+
+    // Compare with (or record) the baseline
+    bool statsOk = true;
+    string baselinePath = options.dir + "/baseline.txt";
+    HarnessTotals baseline;
+    if (!options.updateGolden && ReadBaseline(baselinePath, baseline)) {
+        for (int c = 0; c < RENDER_CATEGORY_COUNT; ++c) {
+            double limit = baseline.drawCalls[c] * (1.0 + options.drawCallTolerance) + 0.5;
+            if (totals.drawCalls[c] > limit) {
+                printf("  REGRESSION %s draw calls %.1f > baseline %.1f\n",
+                    RenderCategoryName((RenderCategory)c), totals.drawCalls[c], baseline.drawCalls[c]);
+                statsOk = false;
+            }
+        }
+        if (totals.blendChanges > baseline.blendChanges * (1.0 + options.drawCallTolerance) + 0.5) {
+            printf("  REGRESSION blend changes %.1f > baseline %.1f\n", totals.blendChanges, baseline.blendChanges);
+            statsOk = false;
+        }
+        if (totals.cpuMs > baseline.cpuMs * (1.0 + options.timeTolerance)) {
+            printf("  REGRESSION cpu render time %.3fms > baseline %.3fms\n", totals.cpuMs, baseline.cpuMs);
+            statsOk = false;
+        }
+    }
+    else {
+        WriteBaseline(baselinePath, totals);
+        printf("  baseline written %s\n", baselinePath.c_str());
+    }
+
+    bloom.Unload();
+    UnloadRenderTexture(world);
+    UnloadRenderTexture(target);
+    CloseWindow();
+
+    bool ok = imagesOk && statsOk;
+    printf("render harness: %s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,24 @@
+#pragma once
+#include <string>
+
+// -------------------------
+// Offscreen render regression harness
+// -------------------------
+// Flies the camera through the level on a scripted path, renders each
+// frame into an offscreen target and records per-frame draw calls,
+// vertices, blend changes and CPU render time. Key camera positions are
+// captured as golden images and pixel-diffed on later runs; the totals are
+// compared against a stored baseline. Meant to run hidden, e.g. under
+// Xvfb with LIBGL_ALWAYS_SOFTWARE=1.
+// -------------------------
+
+struct HarnessOptions {
+    std::string dir = "harness";    // golden images and baseline.txt
+    bool updateGolden = false;      // overwrite goldens and baseline instead of comparing
+    float drawCallTolerance = 0.05f;
+    float timeTolerance = 0.25f;
+    float pixelTolerance = 0.005f;  // fraction of pixels allowed to differ
+};
+
+// Returns the process exit code: 0 when nothing regressed.
+int RunRenderHarness(const HarnessOptions& options);
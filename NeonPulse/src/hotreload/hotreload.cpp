@@ -0,0 +1,52 @@
+#include "hotreload.h"
+#include "raylib.h"
+
+using namespace std;
+
+// -------------------------
+// LevelWatcher
+// -------------------------
+
+constexpr double LevelWatcher::kPollInterval;
+
+void LevelWatcher::Watch(const string& file) {
+    path = file;
+    modTime = GetFileModTime(path.c_str());
+    nextPoll = 0.0;
+}
+
+bool LevelWatcher::Changed(double now) {
+    if (path.empty() || now < nextPoll) return false;
+    nextPoll = now + kPollInterval;
+
+    long t = GetFileModTime(path.c_str());
+    if (t == modTime) return false;
+    modTime = t;
+    return true;
+}
+
+// -------------------------
+// Reload
+// -------------------------
+
+bool ReloadLevel(unique_ptr<Level>& level, const char* path, ReloadStats& stats) {
+    double t0 = GetTime();
+    unique_ptr<Level> fresh(new Level());
+
+    // Hand the current grid to the new level so only changed chunks are rebuilt
+    fresh->grid = move(level->grid);
+
+    if (!LoadLevelFile(*fresh, path, &stats.chunksRebuilt)) {
+        level->grid = move(fresh->grid);
+        TraceLog(LOG_WARNING, "LEVEL: reload of %s failed, keeping the current level", path);
+        return false;
+    }
+
+    stats.chunkCount = (int)fresh->grid.chunks.size();
+    const ChunkGrid& grid = fresh->grid;
+    stats.entities = (int)(grid.platforms.size() + grid.spikes.color.size() + grid.jumpPads.size() +
+        grid.speedPads.size() + grid.gravityPads.size());
+    level = move(fresh);
+    stats.ms = (float)((GetTime() - t0) * 1000.0);
+    return true;
+}
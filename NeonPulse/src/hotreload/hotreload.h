@@ -0,0 +1,41 @@
+#pragma once
+#include <memory>
+#include <string>
+#include "../level/level.h"
+
+// -------------------------
+// Level hot-reload
+// -------------------------
+// LevelWatcher polls a level file's modification time; ReloadLevel parses
+// the new version into a fresh Level, moves the old chunk grid over and
+// rebuilds only the chunks whose entities changed. Gameplay state is not
+// touched, so the player carries on from where they are.
+// -------------------------
+
+class LevelWatcher {
+public:
+    void Watch(const std::string& path);
+    bool Active() const { return !path.empty(); }
+    const char* Path() const { return path.c_str(); }
+
+    // True once per change of the file on disk. Cheap to call every frame:
+    // the file is only stat'ed every kPollInterval seconds.
+    bool Changed(double now);
+
+private:
+    static constexpr double kPollInterval = 0.25;
+
+    std::string path;
+    long modTime = 0;
+    double nextPoll = 0.0;
+};
+
+struct ReloadStats {
+    int chunksRebuilt;
+    int chunkCount;
+    int entities;
+    float ms;
+};
+
+// Replaces *level on success; on a parse error the current level stays.
+bool ReloadLevel(std::unique_ptr<Level>& level, const char* path, ReloadStats& stats);
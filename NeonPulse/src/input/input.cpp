@@ -0,0 +1,114 @@
+#include "input.h"
+
+// raylib links GLFW in (rglfw) and ships its header under src/external
+#define GLFW_INCLUDE_NONE
+#include "glfw/include/GLFW/glfw3.h"
+
+// -------------------------
+// Key callback
+// -------------------------
+
+static InputLatch* gLatch = nullptr;
+static GLFWkeyfun gRaylibKeyCallback = nullptr;
+
+static void LatchKeyCallback(GLFWwindow* window, int key, int scancode, int action, int mods) {
+    // raylib's own bookkeeping first, so IsKeyPressed/IsKeyDown keep working
+    if (gRaylibKeyCallback) gRaylibKeyCallback(window, key, scancode, action, mods);
+    if (gLatch && (key == KEY_SPACE || key == KEY_UP) && action != GLFW_REPEAT) {
+        gLatch->OnJumpKey(key, action == GLFW_PRESS, GetTime());
+    }
+}
+
+// -------------------------
+// InputLatch
+// -------------------------
+
+static bool JumpPressed() {
+    return IsKeyPressed(KEY_SPACE) || IsKeyPressed(KEY_UP);
+}
+
+static bool JumpDown() {
+    return IsKeyDown(KEY_SPACE) || IsKeyDown(KEY_UP);
+}
+
+InputLatch::~InputLatch() {
+    if (gLatch == this) gLatch = nullptr;
+}
+
+void InputLatch::Install() {
+    GLFWwindow* window = glfwGetCurrentContext();
+    if (!window || gLatch) return;
+    gLatch = this;
+    gRaylibKeyCallback = glfwSetKeyCallback(window, LatchKeyCallback);
+    spaceDown = IsKeyDown(KEY_SPACE);
+    upDown = IsKeyDown(KEY_UP);
+    heldAtLatch = spaceDown || upDown;
+    installed = true;
+}
+
+void InputLatch::OnJumpKey(int key, bool down, double time) {
+    bool& keyDown = key == KEY_SPACE ? spaceDown : upDown;
+    bool pressed = down && !keyDown;
+    keyDown = down;
+    JumpEdge edge = { time, pressed, spaceDown || upDown };
+
+    // Out of room: fold into the last edge, keeping any press it carried
+    if (pendingCount == kMaxJumpEdges) {
+        JumpEdge& last = pending[kMaxJumpEdges - 1];
+        edge.pressed = edge.pressed || last.pressed;
+        if (last.pressed) edge.time = last.time;
+        last = edge;
+        return;
+    }
+    pending[pendingCount++] = edge;
+}
+
+InputSample InputLatch::Latch() {
+    InputSample s = {};
+    if (!installed) {
+        s.jumpPressed = JumpPressed();
+        s.jumpHeld = JumpDown();
+        s.heldBefore = s.jumpHeld;
+        s.pressTime = s.jumpPressed ? framePollTime : 0.0;
+        s.latchTime = GetTime();
+        return s;
+    }
+
+    // Late poll: presses since EndDrawing's poll are still this frame's
+    glfwPollEvents();
+    s.latchTime = GetTime();
+    s.heldBefore = heldAtLatch;
+    s.edgeCount = pendingCount;
+    for (int i = 0; i < pendingCount; ++i) {
+        s.edges[i] = pending[i];
+        if (pending[i].pressed && !s.jumpPressed) {
+            s.jumpPressed = true;
+            s.pressTime = pending[i].time;
+        }
+    }
+    s.jumpHeld = spaceDown || upDown;
+    heldAtLatch = s.jumpHeld;
+    pendingCount = 0;
+    return s;
+}
+
+bool JumpHeldAt(const InputSample& input, double stepEnd) {
+    bool held = input.heldBefore;
+    for (int i = 0; i < input.edgeCount && input.edges[i].time < stepEnd; ++i) held = input.edges[i].held;
+    return held;
+}
+
+// -------------------------
+// Latency estimate
+// -------------------------
+
+void UpdateLatencyStats(LatencyStats& stats, const InputSample& input, bool pressApplied,
+    double submitTime, double refreshInterval) {
+    double photon = submitTime + refreshInterval;
+    stats.lastSampleMs = (float)((photon - input.latchTime) * 1000.0);
+    if (input.jumpPressed && pressApplied) {
+        stats.lastPressMs = (float)((photon - input.pressTime) * 1000.0);
+        stats.presses++;
+        stats.avgPressMs += (stats.lastPressMs - stats.avgPressMs) / stats.presses;
+    }
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include "raylib.h"
+
+// -------------------------
+// Late-latched input
+// -------------------------
+// raylib 5.5 ends a frame in EndDrawing() with: buffer swap, frame-rate
+// wait, then PollInputEvents(), and its key state cannot say when in that
+// window a key went down. InputLatch chains a GLFW key callback behind
+// raylib's own, which stamps every jump key edge with GetTime() as GLFW
+// delivers it. Latch() runs right before the simulation: it dispatches the
+// events that arrived since EndDrawing (glfwPollEvents, which leaves
+// raylib's pressed/released bookkeeping alone) and hands over the edges,
+// so the fixed-step loop can put a press on the sub-step its time falls in.
+//
+// Edge times are when GLFW dispatched the event, so a press made during
+// the frame-rate wait is stamped at the end of the wait: press latencies
+// are lower bounds. Without the callback (Install not called, or no GLFW
+// window) presses are stamped with the time of the EndDrawing poll.
+// -------------------------
+
+const int kMaxJumpEdges = 16;
+
+struct JumpEdge {
+    double time;  // GetTime() clock
+    bool pressed; // a jump key went down (key repeat does not count)
+    bool held;    // any jump key down after this edge
+};
+
+struct InputSample {
+    bool jumpPressed;   // any press since the last latch
+    bool jumpHeld;      // at the latch
+    bool heldBefore;    // at the previous latch
+    double pressTime;   // first press since the last latch
+    double latchTime;   // when this sample was taken
+    int edgeCount;      // in time order; presses past kMaxJumpEdges are merged into the last
+    JumpEdge edges[kMaxJumpEdges];
+};
+
+class InputLatch {
+public:
+    ~InputLatch();
+
+    // After InitWindow(): starts timestamping jump key edges.
+    void Install();
+
+    // Call right after EndDrawing(), whose last step is the input poll.
+    void MarkFramePolled() { framePollTime = GetTime(); }
+
+    InputSample Latch();
+
+    // Called from the GLFW key callback
+    void OnJumpKey(int key, bool down, double time);
+
+private:
+    bool installed = false;
+    double framePollTime = 0.0;
+    bool spaceDown = false;
+    bool upDown = false;
+    bool heldAtLatch = false;
+    int pendingCount = 0;
+    JumpEdge pending[kMaxJumpEdges];
+};
+
+// Jump input for a fixed step ending at stepEnd: held state from the edges
+// up to stepEnd (the state at the latch past the last edge)
+bool JumpHeldAt(const InputSample& input, double stepEnd);
+
+// -------------------------
+// Input-to-photon latency estimate
+// -------------------------
+// Photon time is approximated as the frame's hand-off to EndDrawing(),
+// which flushes and swaps before its frame-rate wait, plus one refresh
+// interval (scan-out); it ignores display processing lag.
+// -------------------------
+
+struct LatencyStats {
+    float lastSampleMs;   // latch -> photon for the latest frame
+    float lastPressMs;    // press -> photon for the latest jump press
+    float avgPressMs;
+    int presses;
+};
+
+void UpdateLatencyStats(LatencyStats& stats, const InputSample& input, bool pressApplied,
+    double submitTime, double refreshInterval);
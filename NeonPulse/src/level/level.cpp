@@ -0,0 +1,382 @@
+#include "level.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+using namespace std;
+
+// -------------------------
+// Level construction
+// -------------------------
+
+Level::Level()
+    : sections(ArenaAllocator<Section>(&arena)),
+    layers(ArenaAllocator<ParallaxLayer>(&arena)),
+    platforms(ArenaAllocator<MovingPlatform>(&entityArena)),
+    spikes(ArenaAllocator<Spike>(&entityArena)),
+    arches(ArenaAllocator<Arch>(&arena)),
+    jumpPads(ArenaAllocator<JumpPad>(&entityArena)),
+    speedPads(ArenaAllocator<SpeedPad>(&entityArena)),
+    gravityPads(ArenaAllocator<GravityPad>(&entityArena)),
+    finishLine{ 0.0f, 0.0f, 0.0f, 0.0f } {
+}
+
+unique_ptr<Level> CreateLevel(int screenH) {
+    unique_ptr<Level> level(new Level());
+    BuildLevel(*level, screenH);
+    return level;
+}
+
+void BuildLevel(Level& level, int screenH) {
+    BuildLevelLayout(level, screenH);
+    UpdateChunkGrid(level.grid, level);
+    ReleaseEntityLists(level);
+    BuildParallaxField(level.parallax, level.layers);
+}
+
+template <typename T>
+static void ReleaseList(LevelVector<T>& list) {
+    LevelVector<T>(list.get_allocator()).swap(list);
+}
+
+void ReleaseEntityLists(Level& level) {
+    ReleaseList(level.platforms);
+    ReleaseList(level.spikes);
+    ReleaseList(level.jumpPads);
+    ReleaseList(level.speedPads);
+    ReleaseList(level.gravityPads);
+    level.entityArena.Release();
+    level.entitiesReleased = true;
+}
+
+void BuildLevelLayout(Level& level, int screenH) {
+    // Sections (visual)
+    level.sections = {
+        { 0.0f,     1200.0f,  { 20, 30, 60, 255 }, { 40, 10, 80, 255 } },
+        { 1200.0f,  2600.0f,  { 10, 50, 80, 255 }, { 0, 20, 40, 255 } },
+        { 2600.0f,  4200.0f,  { 10, 10, 40, 255 }, { 40, 0, 60, 255 } },
+        { 4200.0f,  7600.0f,  { 8, 12, 26, 255  }, { 18, 26, 64, 255 } },
+    };
+
+    // Parallax layers
+    level.layers = {
+        { 0.06f, neonBlue,   16, 10.0f, 30.0f },
+        { 0.12f, neonPurple, 20, 6.0f,  20.0f },
+        { 0.22f, neonCyan,   28, 4.0f,  14.0f },
+    };
+
+    // helper to add spike clusters
+    auto addSpikeClusterLocal = [&](float startX, int count, float w, float h, bool up, Color c) {
+        for (int i = 0; i < count; i++) {
+            float x = startX + i * (w * 0.86f);
+            float y = up ? (defaultFloorY - h) : (ceilingYTop);
+            level.spikes.push_back({ { x, y, w, h }, up, c });
+        }
+     };
+
+
+    // --- Intro: tutorial ---
+    {
+        addSpikeClusterLocal(900.0f, 1, 36.0f, 56.0f, true, neonYellow);
+        addSpikeClusterLocal(1300.0f, 2, 36.0f, 56.0f, true, neonYellow);
+    }
+
+    // --- Easy rhythm (small hops) ---
+    {
+        level.platforms.push_back({ { 1780,  defaultFloorY - 72, 140, 20 }, 0, 0.0f, false, neonGreen, 0.0f });
+        level.platforms.push_back({ { 2060,  defaultFloorY - 84, 140, 20 }, 0, 0.0f, false, neonCyan, 0.0f });
+        level.platforms.push_back({ { 2340, defaultFloorY - 100, 140, 20 }, 0, 0.0f, false, neonMagenta, 0.0f });
+
+        // small, single spike intro
+        addSpikeClusterLocal(2200.0f, 2, 36.0f, 56.0f, true, neonYellow);
+    }
+
+
+
+    // --- Beat Hop: consistent spacing, one intended path ---
+    {
+        float beatGap = 180.0f; // shorter spacing for easier planning
+        float beatStart = 2620.0f;
+        for (int i = 0; i < 8; ++i) {
+            // small vertical oscillation but intentionally small so path is predictable
+            float yOff = (i % 2 == 0) ? -128.0f : -140.0f;
+            Color c = (i % 2 == 0) ? neonBlue : neonPurple;
+            level.platforms.push_back({ { beatStart + i * beatGap, defaultFloorY + yOff, 110, 18 }, 0.0f, 0.0f, false, c, 0.0f });
+        }
+        for (int i = 0; i < 8; ++i) {
+            // center the spike cluster in the gap between platforms
+            float gapCenterX = beatStart + i * beatGap - beatGap * 0.5f;
+            // place 3 upward-facing spikes covering the gap
+            addSpikeClusterLocal(gapCenterX - 16.0f, 6, 34.0f, 60.0f, true, neonMagenta);
+        }
+    }
+
+    // --- Speedlaunch (short boost into a simple chain) ---
+    {
+        level.speedPads.push_back({ { 4100, defaultFloorY - 8, 66, 8 }, 1.35f, 0.9f, neonGreen });
+        level.platforms.push_back({ { 4260, defaultFloorY - 120, 160, 20 }, 0.0f, 0.0f, false, neonCyan, 0.0f });
+    }
+
+    // --- Gravity Flip segment: flip gravity, run on ceiling over a fixed distance ---
+    { 
+        // place a GravityPad that flips gravity to inverted
+        level.gravityPads.push_back({ { 4520.0f, defaultFloorY - 24, 56, 16 }, neonPurple, true});
+
+     // Ceiling platforms (intended path while gravity inverted) - placed near the ceiling
+        float ceilingStart = 4660.0f;
+
+        for (int i = 1; i < 6; i++) {
+            float x = ceilingStart + i * 300.0f - i * i / 2 * 8;
+            addSpikeClusterLocal(x, 4, 35.0f, 50.0f, false, neonMagenta);
+        }
+
+        addSpikeClusterLocal(ceilingStart - 40.0f, 30, 36.0f, 70.0f, true, neonYellow);
+
+        // GravityPad to flip back to normal gravity after the ceiling run
+        level.gravityPads.push_back({ { ceilingStart + 8.5f * 200.0f, ceilingYTop + 6.0f, 56, 16 }, neonPurple, false});
+
+        addSpikeClusterLocal(ceilingStart + 10.0f * 200.0f, 8, 36.0f, 70.0f, false, neonYellow);
+    }
+
+    
+
+    // --- Jumpad trick ---
+    {
+        float trickStart = 6800.0f;
+        level.platforms.push_back({ { trickStart + 475.0f,  defaultFloorY - 84, 140, 20 }, 0, 0.0f, false, neonCyan, 0.0f });
+        level.jumpPads.push_back({ { trickStart + 400.0f, defaultFloorY - 32, 60, 16 }, 1.45f, neonYellow });
+        addSpikeClusterLocal(trickStart + 675.0f, 4, 36.0f, 70.0f, true, neonBlue);
+    }
+
+    // --- Fianl Jump ---
+    {
+        float finalStart = 7700.0f;
+        level.speedPads.push_back({ { finalStart + 475.0f, defaultFloorY - 8, 66, 8 }, 1.35f, 2.0f, neonGreen });
+        addSpikeClusterLocal(finalStart + 675.0f, 6, 34.0f, 70.0f, true, neonMagenta);
+    }
+
+
+    // Finish zone
+    level.finishLine = { 9100.0f, 0.0f, 8.0f, (float)screenH };
+}
+
+// -------------------------
+// Level files
+// -------------------------
+
+// Bounds on what a file may hold, so a broken one is rejected here rather
+// than reaching the chunk math (float to int) or sizing an allocation
+static const float kMaxFileCoord = 1.0e7f;   // |x|, |y| and platform amplitude
+static const float kMaxFileSize = 1.0e5f;    // width, height
+static const float kMaxFileFactor = 1.0e3f;  // speeds, strengths, durations, phases
+static const int kMaxLayerDensity = 4096;
+
+static bool FileCoord(float v) { return isfinite(v) && fabsf(v) <= kMaxFileCoord; }
+static bool FileSize(float v) { return isfinite(v) && v > 0.0f && v <= kMaxFileSize; }
+static bool FileFactor(float v) { return isfinite(v) && fabsf(v) <= kMaxFileFactor; }
+
+static bool FileRect(const Rectangle& r) {
+    return FileCoord(r.x) && FileCoord(r.y) && FileSize(r.width) && FileSize(r.height);
+}
+
+static bool ToColor(const int c[4], Color& out) {
+    for (int i = 0; i < 4; ++i) {
+        if (c[i] < 0 || c[i] > 255) return false;
+    }
+    out = { (unsigned char)c[0], (unsigned char)c[1], (unsigned char)c[2], (unsigned char)c[3] };
+    return true;
+}
+
+// Returns false when the line is not a valid entity description or a value
+// is out of range
+static bool ParseLevelLine(Level& level, const char* line) {
+    char kind[16];
+    int n = 0;
+    if (sscanf(line, "%15s%n", kind, &n) != 1) return true; // blank
+    const char* args = line + n;
+
+    Rectangle r;
+    int a[4], b[4], flag;
+    float f0, f1, f2;
+    Color ca, cb;
+
+    if (strcmp(kind, "section") == 0) {
+        if (sscanf(args, "%f %f %d %d %d %d %d %d %d %d", &f0, &f1, &a[0], &a[1], &a[2], &a[3], &b[0], &b[1], &b[2], &b[3]) != 10) return false;
+        if (!FileCoord(f0) || !FileCoord(f1) || f0 >= f1 || !ToColor(a, ca) || !ToColor(b, cb)) return false;
+        level.sections.push_back({ f0, f1, ca, cb });
+    }
+    else if (strcmp(kind, "layer") == 0) {
+        if (sscanf(args, "%f %d %d %d %d %d %f %f", &f0, &a[0], &a[1], &a[2], &a[3], &flag, &f1, &f2) != 8) return false;
+        if (!FileFactor(f0) || !ToColor(a, ca) || flag < 0 || flag > kMaxLayerDensity ||
+            !FileSize(f1) || !FileSize(f2) || f1 > f2) return false;
+        level.layers.push_back({ f0, ca, flag, f1, f2 });
+    }
+    else if (strcmp(kind, "platform") == 0) {
+        float phase;
+        if (sscanf(args, "%f %f %f %f %f %f %d %d %d %d %d %f", &r.x, &r.y, &r.width, &r.height, &f0, &f1, &flag,
+            &a[0], &a[1], &a[2], &a[3], &phase) != 12) return false;
+        if (!FileRect(r) || !FileCoord(f0) || !FileFactor(f1) || !FileFactor(phase) || !ToColor(a, ca)) return false;
+        level.platforms.push_back({ r, f0, f1, flag != 0, ca, phase });
+    }
+    else if (strcmp(kind, "spike") == 0) {
+        if (sscanf(args, "%f %f %f %f %d %d %d %d %d", &r.x, &r.y, &r.width, &r.height, &flag, &a[0], &a[1], &a[2], &a[3]) != 9) return false;
+        if (!FileRect(r) || !ToColor(a, ca)) return false;
+        level.spikes.push_back({ r, flag != 0, ca });
+    }
+    else if (strcmp(kind, "jumppad") == 0) {
+        if (sscanf(args, "%f %f %f %f %f %d %d %d %d", &r.x, &r.y, &r.width, &r.height, &f0, &a[0], &a[1], &a[2], &a[3]) != 9) return false;
+        if (!FileRect(r) || !FileFactor(f0) || !ToColor(a, ca)) return false;
+        level.jumpPads.push_back({ r, f0, ca });
+    }
+    else if (strcmp(kind, "speedpad") == 0) {
+        if (sscanf(args, "%f %f %f %f %f %f %d %d %d %d", &r.x, &r.y, &r.width, &r.height, &f0, &f1, &a[0], &a[1], &a[2], &a[3]) != 10) return false;
+        if (!FileRect(r) || !FileFactor(f0) || !FileFactor(f1) || !ToColor(a, ca)) return false;
+        level.speedPads.push_back({ r, f0, f1, ca });
+    }
+    else if (strcmp(kind, "gravitypad") == 0) {
+        if (sscanf(args, "%f %f %f %f %d %d %d %d %d", &r.x, &r.y, &r.width, &r.height, &flag, &a[0], &a[1], &a[2], &a[3]) != 9) return false;
+        if (!FileRect(r) || !ToColor(a, ca)) return false;
+        level.gravityPads.push_back({ r, ca, flag != 0 });
+    }
+    else if (strcmp(kind, "finish") == 0) {
+        if (sscanf(args, "%f %f %f %f", &r.x, &r.y, &r.width, &r.height) != 4 || !FileRect(r)) return false;
+        level.finishLine = r;
+    }
+    else {
+        return false;
+    }
+    return true;
+}
+
+// The lists live in the level arenas, where a growing vector leaves its old
+// buffer behind: size them from the file before filling them
+static void ReserveLevelLists(Level& level, const char* text) {
+    static const char* const kinds[] = { "section", "layer", "platform", "spike", "jumppad", "speedpad", "gravitypad" };
+    size_t counts[7] = {};
+    for (const char* line = text; line;) {
+        while (*line == ' ' || *line == '\t') line++;
+        for (int k = 0; k < 7; ++k) {
+            size_t len = strlen(kinds[k]);
+            if (strncmp(line, kinds[k], len) == 0 && (line[len] == ' ' || line[len] == '\t')) counts[k]++;
+        }
+        line = strchr(line, '\n');
+        if (line) line++;
+    }
+    level.sections.reserve(level.sections.size() + counts[0]);
+    level.layers.reserve(level.layers.size() + counts[1]);
+    level.platforms.reserve(level.platforms.size() + counts[2]);
+    level.spikes.reserve(level.spikes.size() + counts[3]);
+    level.jumpPads.reserve(level.jumpPads.size() + counts[4]);
+    level.speedPads.reserve(level.speedPads.size() + counts[5]);
+    level.gravityPads.reserve(level.gravityPads.size() + counts[6]);
+}
+
+bool LoadLevelFile(Level& level, const char* path, int* chunksRebuilt) {
+    if (!ParseLevelFile(level, path)) return false;
+    int rebuilt = UpdateChunkGrid(level.grid, level);
+    if (chunksRebuilt) *chunksRebuilt = rebuilt;
+    ReleaseEntityLists(level);
+    BuildParallaxField(level.parallax, level.layers);
+    return true;
+}
+
+bool ParseLevelFile(Level& level, const char* path) {
+    char* text = LoadFileText(path);
+    if (!text) return false;
+    ReserveLevelLists(level, text);
+
+    bool ok = true;
+    int lineNumber = 0;
+    char* line = text;
+    while (line && ok) {
+        char* next = strchr(line, '\n');
+        if (next) *next++ = '\0';
+        lineNumber++;
+
+        char* comment = strchr(line, '#');
+        if (comment) *comment = '\0';
+        if (!ParseLevelLine(level, line)) {
+            TraceLog(LOG_WARNING, "LEVEL: %s:%d: cannot parse \"%s\"", path, lineNumber, line);
+            ok = false;
+        }
+        line = next;
+    }
+    UnloadFileText(text);
+
+    if (ok && level.sections.empty()) {
+        TraceLog(LOG_WARNING, "LEVEL: %s: no sections", path);
+        ok = false;
+    }
+    if (ok && !LevelFitsChunkGrid(level)) {
+        TraceLog(LOG_WARNING, "LEVEL: %s: entities that cannot be stored exactly", path);
+        ok = false;
+    }
+    return ok;
+}
+
+bool SaveLevelFile(const Level& level, const char* path) {
+    if (level.entitiesReleased) {
+        TraceLog(LOG_WARNING, "LEVEL: %s: entity lists already released, not saving", path);
+        return false;
+    }
+    string out = "# Neon Pulse level\n";
+    char buf[256];
+    // Formatted into a returned buffer, not TextFormat: LevelPrep saves from a worker thread
+    struct ColorText { char s[20]; };
+    auto color = [](Color c) {
+        ColorText t;
+        snprintf(t.s, sizeof(t.s), "%d %d %d %d", c.r, c.g, c.b, c.a);
+        return t;
+    };
+
+    for (const auto& s : level.sections) {
+        snprintf(buf, sizeof(buf), "section %.9g %.9g %s", s.startX, s.endX, color(s.bgA).s);
+        out += buf;
+        out += " ";
+        out += color(s.bgB).s;
+        out += "\n";
+    }
+    for (const auto& l : level.layers) {
+        snprintf(buf, sizeof(buf), "layer %.9g %s %d %.9g %.9g\n", l.speed, color(l.color).s, l.density, l.scaleMin, l.scaleMax);
+        out += buf;
+    }
+    for (const auto& p : level.platforms) {
+        snprintf(buf, sizeof(buf), "platform %.9g %.9g %.9g %.9g %.9g %.9g %d %s %.9g\n", p.base.x, p.base.y, p.base.width, p.base.height,
+            p.amplitude, p.speed, p.vertical ? 1 : 0, color(p.color).s, p.phase);
+        out += buf;
+    }
+    for (const auto& s : level.spikes) {
+        snprintf(buf, sizeof(buf), "spike %.9g %.9g %.9g %.9g %d %s\n", s.base.x, s.base.y, s.base.width, s.base.height, s.up ? 1 : 0, color(s.color).s);
+        out += buf;
+    }
+    for (const auto& jp : level.jumpPads) {
+        snprintf(buf, sizeof(buf), "jumppad %.9g %.9g %.9g %.9g %.9g %s\n", jp.rect.x, jp.rect.y, jp.rect.width, jp.rect.height, jp.strength, color(jp.color).s);
+        out += buf;
+    }
+    for (const auto& sp : level.speedPads) {
+        snprintf(buf, sizeof(buf), "speedpad %.9g %.9g %.9g %.9g %.9g %.9g %s\n", sp.rect.x, sp.rect.y, sp.rect.width, sp.rect.height,
+            sp.multiplier, sp.duration, color(sp.color).s);
+        out += buf;
+    }
+    for (const auto& gp : level.gravityPads) {
+        snprintf(buf, sizeof(buf), "gravitypad %.9g %.9g %.9g %.9g %d %s\n", gp.rect.x, gp.rect.y, gp.rect.width, gp.rect.height, gp.flipsUp ? 1 : 0, color(gp.color).s);
+        out += buf;
+    }
+    const Rectangle& f = level.finishLine;
+    snprintf(buf, sizeof(buf), "finish %.9g %.9g %.9g %.9g\n", f.x, f.y, f.width, f.height);
+    out += buf;
+
+    return SaveFileText(path, &out[0]);
+}
+
+// -------------------------
+// Queries
+// -------------------------
+
+const Section& CurrentSection(const Level& level, float x) {
+    for (auto& s : level.sections) {
+        if (x >= s.startX && x < s.endX) return s;
+    }
+    return level.sections.back();
+}
@@ -0,0 +1,100 @@
+#pragma once
+#include "raylib.h"
+#include <memory>
+#include "../entities/entities.h"
+#include "../memory/memory.h"
+#include "../spatial/spatial.h"
+#include "../background/background.h"
+
+// -------------------------
+// Level layout
+// -------------------------
+// Everything static about a level: entity lists, visual sections,
+// parallax layers and the finish line. Built once, read by gameplay,
+// rendering and the offscreen harness. All of it is allocated from the
+// level's arenas and released in one go when the Level is destroyed.
+// The data derived from the lists (chunk grid, parallax field) is
+// heap-backed instead, so a hot-reload can carry the grid over to the new
+// Level and patch it in place.
+//
+// The entity lists the chunk grid packs have an arena of their own: once
+// the grid holds every chunk, ReleaseEntityLists frees them and the grid
+// is the only copy. A hot-reload does not need them either, since it
+// compares the new file's lists against the chunk hashes.
+//
+// BuildLevel and LoadLevelFile fill in everything. Startup instead fills
+// the lists with BuildLevelLayout / ParseLevelFile and prepares the derived
+// data on worker threads (see startup.h).
+// -------------------------
+
+// Floor & ceiling
+const float defaultFloorY = 560.0f;
+const float ceilingYTop = 80.0f;
+
+// Colors
+const Color neonCyan = { 0, 255, 255, 255 };
+const Color neonMagenta = { 255, 0, 200, 255 };
+const Color neonYellow = { 255, 240, 0, 255 };
+const Color neonGreen = { 50, 255, 160, 255 };
+const Color neonBlue = { 60, 160, 255, 255 };
+const Color neonPurple = { 170, 60, 255, 255 };
+
+struct Level {
+    Level();
+    Level(const Level&) = delete;
+    Level& operator=(const Level&) = delete;
+
+    // Back every vector below, so they must be declared first
+    Arena arena;
+    Arena entityArena; // platforms, spikes and pads
+
+    LevelVector<Section> sections;
+    LevelVector<ParallaxLayer> layers;
+
+    LevelVector<MovingPlatform> platforms;
+    LevelVector<Spike> spikes;
+    LevelVector<Arch> arches;
+    LevelVector<JumpPad> jumpPads;
+    LevelVector<SpeedPad> speedPads;
+    LevelVector<GravityPad> gravityPads;
+
+    Rectangle finishLine;
+    bool entitiesReleased = false;
+
+    ChunkGrid grid;          // derived from the lists above by UpdateChunkGrid
+    ParallaxField parallax;  // derived from layers by BuildParallaxField
+};
+
+void BuildLevel(Level& level, int screenH);
+void BuildLevelLayout(Level& level, int screenH); // lists only
+std::unique_ptr<Level> CreateLevel(int screenH);
+
+// Frees the packed entity lists; call once the grid holds every chunk.
+// Sections, layers and arches stay.
+void ReleaseEntityLists(Level& level);
+
+// -------------------------
+// Level files
+// -------------------------
+// Plain text, one entity per line, '#' starts a comment. Colors are
+// "r g b a", booleans 0/1:
+//   section    startX endX  bgA bgB
+//   layer      speed color density scaleMin scaleMax
+//   platform   x y w h amplitude speed vertical color phase
+//   spike      x y w h up color
+//   jumppad    x y w h strength color
+//   speedpad   x y w h multiplier duration color
+//   gravitypad x y w h flipsUp color
+//   finish     x y w h
+// Values are checked while parsing: finite, colors 0-255, sizes positive,
+// coordinates and layer densities within fixed bounds (level.cpp).
+// -------------------------
+
+// Fills an empty level from a file and updates its derived data, reporting
+// how many chunks were rebuilt. On failure the level is only partly filled
+// and should be dropped; its grid is left untouched.
+bool LoadLevelFile(Level& level, const char* path, int* chunksRebuilt = nullptr);
+bool ParseLevelFile(Level& level, const char* path); // lists only
+// Fails once the entity lists are released: the grid only has them snapped
+bool SaveLevelFile(const Level& level, const char* path);
+const Section& CurrentSection(const Level& level, float x);
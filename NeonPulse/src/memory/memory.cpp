@@ -0,0 +1,142 @@
+#include "memory.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+
+using namespace std;
+
+// -------------------------
+// Arena
+// -------------------------
+
+Arena::Arena(size_t size) : blockSize(size) {}
+
+Arena::~Arena() {
+    Release();
+}
+
+void Arena::Release() {
+    while (head) {
+        Block* next = head->next;
+        free(head);
+        head = next;
+    }
+}
+
+Arena::Block* Arena::NewBlock(size_t minSize) {
+    size_t size = max(blockSize, minSize);
+    Block* b = static_cast<Block*>(malloc(sizeof(Block) + size));
+    if (!b) throw bad_alloc();
+    b->next = head;
+    b->size = size;
+    b->used = 0;
+    head = b;
+    return b;
+}
+
+void* Arena::Allocate(size_t size, size_t align) {
+    if (head) {
+        uintptr_t base = reinterpret_cast<uintptr_t>(head + 1);
+        uintptr_t p = (base + head->used + align - 1) & ~(uintptr_t)(align - 1);
+        if (p + size <= base + head->size) {
+            head->used = p + size - base;
+            return reinterpret_cast<void*>(p);
+        }
+    }
+    Block* b = NewBlock(size + align);
+    uintptr_t base = reinterpret_cast<uintptr_t>(b + 1);
+    uintptr_t p = (base + align - 1) & ~(uintptr_t)(align - 1);
+    b->used = p + size - base;
+    return reinterpret_cast<void*>(p);
+}
+
+void Arena::Reset() {
+    if (!head) return;
+    if (head->next) {
+        // Spilled into several blocks: replace them with one that fits all of
+        // it, so the next round stays inside a single block.
+        size_t total = BytesReserved();
+        Release();
+        NewBlock(total);
+    }
+    head->used = 0;
+}
+
+size_t Arena::BytesUsed() const {
+    size_t total = 0;
+    for (Block* b = head; b; b = b->next) total += b->used;
+    return total;
+}
+
+size_t Arena::BytesReserved() const {
+    size_t total = 0;
+    for (Block* b = head; b; b = b->next) total += b->size;
+    return total;
+}
+
+// -------------------------
+// Allocation tracking
+// -------------------------
+
+static atomic<uint64_t> gAllocCount{ 0 };
+static atomic<uint64_t> gAllocBytes{ 0 };
+
+uint64_t GetAllocationCount() { return gAllocCount.load(memory_order_relaxed); }
+uint64_t GetAllocatedBytes() { return gAllocBytes.load(memory_order_relaxed); }
+
+static void* TrackedAlloc(size_t size) {
+    gAllocCount.fetch_add(1, memory_order_relaxed);
+    gAllocBytes.fetch_add(size, memory_order_relaxed);
+    void* p = malloc(size ? size : 1);
+    if (!p) throw bad_alloc();
+    return p;
+}
+
+void* operator new(size_t size) { return TrackedAlloc(size); }
+void* operator new[](size_t size) { return TrackedAlloc(size); }
+void* operator new(size_t size, const nothrow_t&) noexcept {
+    try { return TrackedAlloc(size); } catch (...) { return nullptr; }
+}
+void* operator new[](size_t size, const nothrow_t&) noexcept {
+    try { return TrackedAlloc(size); } catch (...) { return nullptr; }
+}
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+void operator delete(void* p, const nothrow_t&) noexcept { free(p); }
+void operator delete[](void* p, const nothrow_t&) noexcept { free(p); }
+
+#if defined(__cpp_aligned_new)
+// Over-aligned types (C++17). The block malloc returned is stored just
+// below the aligned pointer, so only the aligned deletes below free these.
+static void* TrackedAlignedAlloc(size_t size, align_val_t alignment) {
+    size_t align = max((size_t)alignment, sizeof(void*));
+    gAllocCount.fetch_add(1, memory_order_relaxed);
+    gAllocBytes.fetch_add(size, memory_order_relaxed);
+    void* raw = malloc(size + align + sizeof(void*));
+    if (!raw) throw bad_alloc();
+    uintptr_t p = (reinterpret_cast<uintptr_t>(raw) + sizeof(void*) + align - 1) & ~(uintptr_t)(align - 1);
+    reinterpret_cast<void**>(p)[-1] = raw;
+    return reinterpret_cast<void*>(p);
+}
+
+static void AlignedFree(void* p) {
+    if (p) free(static_cast<void**>(p)[-1]);
+}
+
+void* operator new(size_t size, align_val_t align) { return TrackedAlignedAlloc(size, align); }
+void* operator new[](size_t size, align_val_t align) { return TrackedAlignedAlloc(size, align); }
+void* operator new(size_t size, align_val_t align, const nothrow_t&) noexcept {
+    try { return TrackedAlignedAlloc(size, align); } catch (...) { return nullptr; }
+}
+void* operator new[](size_t size, align_val_t align, const nothrow_t&) noexcept {
+    try { return TrackedAlignedAlloc(size, align); } catch (...) { return nullptr; }
+}
+void operator delete(void* p, align_val_t) noexcept { AlignedFree(p); }
+void operator delete[](void* p, align_val_t) noexcept { AlignedFree(p); }
+void operator delete(void* p, size_t, align_val_t) noexcept { AlignedFree(p); }
+void operator delete[](void* p, size_t, align_val_t) noexcept { AlignedFree(p); }
+void operator delete(void* p, align_val_t, const nothrow_t&) noexcept { AlignedFree(p); }
+void operator delete[](void* p, align_val_t, const nothrow_t&) noexcept { AlignedFree(p); }
+#endif
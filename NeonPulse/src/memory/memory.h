@@ -0,0 +1,90 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+// -------------------------
+// Memory: arenas and allocation tracking
+// -------------------------
+// Arena hands out memory by bumping a pointer through large blocks and
+// frees everything at once when it is reset, released or destroyed. Level
+// data lives in two (through ArenaAllocator / LevelVector); per-frame
+// scratch lives in a FrameArena that is reset at the top of every frame.
+// -------------------------
+
+class Arena {
+public:
+    explicit Arena(size_t blockSize = 64 * 1024);
+    ~Arena();
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    void* Allocate(size_t size, size_t align);
+
+    template <typename T>
+    T* AllocArray(size_t count) {
+        return static_cast<T*>(Allocate(sizeof(T) * count, alignof(T)));
+    }
+
+    // Rewinds to empty but keeps the memory, so steady-state reuse
+    // (e.g. once per frame) does not touch the heap.
+    void Reset();
+    // Rewinds to empty and frees every block
+    void Release();
+
+    size_t BytesUsed() const;
+    size_t BytesReserved() const;
+
+private:
+    struct Block {
+        Block* next;
+        size_t size;
+        size_t used;
+    };
+
+    Block* NewBlock(size_t minSize);
+
+    Block* head = nullptr; // current block; older ones follow via next
+    size_t blockSize;
+};
+
+// Frame-lifetime scratch; Reset() once per frame
+typedef Arena FrameArena;
+
+// std allocator adapter. Deallocation is a no-op: memory goes back when
+// the owning arena dies. A vector that grows leaves its old buffer behind,
+// so reserve level lists up front where the size is known (ParseLevelFile).
+template <typename T>
+struct ArenaAllocator {
+    typedef T value_type;
+
+    Arena* arena;
+
+    explicit ArenaAllocator(Arena* a) : arena(a) {}
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.arena) {}
+
+    T* allocate(size_t n) { return static_cast<T*>(arena->Allocate(sizeof(T) * n, alignof(T))); }
+    void deallocate(T*, size_t) {}
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>& o) const { return arena == o.arena; }
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U>& o) const { return arena != o.arena; }
+};
+
+template <typename T>
+using LevelVector = std::vector<T, ArenaAllocator<T>>;
+
+// -------------------------
+// Allocation tracking
+// -------------------------
+// Global operator new/delete are replaced (memory.cpp) to count calls, so
+// code can check that a steady-state frame does not touch the heap. The
+// nothrow and, under C++17, the aligned forms are counted as well.
+// Allocations made by raylib through malloc are not counted.
+// -------------------------
+
+uint64_t GetAllocationCount();
+uint64_t GetAllocatedBytes();
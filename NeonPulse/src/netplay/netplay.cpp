@@ -0,0 +1,471 @@
+#include "netplay.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace std;
+
+// -------------------------
+// Input encoding
+// -------------------------
+
+uint8_t EncodeInput(const StepInput& input) {
+    return (uint8_t)((input.jumpPressed ? kNetJumpPressed : 0) |
+        (input.jumpHeld ? kNetJumpHeld : 0) |
+        (input.restart ? kNetRestart : 0));
+}
+
+StepInput DecodeInput(uint8_t bits) {
+    return { (bits & kNetJumpPressed) != 0, (bits & kNetJumpHeld) != 0, (bits & kNetRestart) != 0 };
+}
+
+// -------------------------
+// State checksum
+// -------------------------
+
+static const uint32_t kChecksumSeed = 2166136261u;
+
+static void HashBytes(uint32_t& h, const void* data, size_t size) {
+    const unsigned char* p = (const unsigned char*)data;
+    for (size_t i = 0; i < size; ++i) {
+        h ^= p[i];
+        h *= 16777619u;
+    }
+}
+
+static void HashFloat(uint32_t& h, float v) { HashBytes(h, &v, sizeof(v)); }
+static void HashInt(uint32_t& h, int v) { HashBytes(h, &v, sizeof(v)); }
+static void HashBool(uint32_t& h, bool v) { unsigned char b = v; HashBytes(h, &b, 1); }
+
+static void HashState(uint32_t& h, const GameState& s) {
+    HashFloat(h, s.songTime);
+    HashFloat(h, s.player.x);
+    HashFloat(h, s.player.y);
+    HashFloat(h, s.player.width);
+    HashFloat(h, s.player.height);
+    HashFloat(h, s.playerVel.x);
+    HashFloat(h, s.playerVel.y);
+    HashFloat(h, s.baseRunSpeed);
+    HashFloat(h, s.runSpeed);
+    HashBool(h, s.grounded);
+    HashBool(h, s.alive);
+    HashFloat(h, s.deathShake);
+    HashBool(h, s.holdJumpActive);
+    HashBool(h, s.prevGrounded);
+    HashInt(h, s.gravityDir);
+    HashFloat(h, s.gravityFlipTimer);
+    HashBool(h, s.levelFinished);
+    HashFloat(h, s.speedTimer);
+    HashFloat(h, s.speedMultiplierActive);
+}
+
+uint32_t GameChecksum(const GameState& state) {
+    uint32_t h = kChecksumSeed;
+    HashState(h, state);
+    return h;
+}
+
+static uint32_t PairChecksum(const GameState& first, const GameState& second) {
+    uint32_t h = kChecksumSeed;
+    HashState(h, first);
+    HashState(h, second);
+    return h;
+}
+
+// -------------------------
+// LoopbackTransport
+// -------------------------
+
+void LoopbackTransport::Configure(const LinkConfig& c) {
+    config = c;
+    rng = c.seed ? c.seed : 1;
+    queues[0].clear();
+    queues[1].clear();
+    sent = dropped = 0;
+}
+
+float LoopbackTransport::Random01() {
+    // xorshift32: fixed sequence per seed, independent of GetRandomValue
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return (rng >> 8) / 16777216.0f;
+}
+
+void LoopbackTransport::Send(int to, const InputPacket& packet, double now) {
+    sent++;
+    if (Random01() < config.lossRate) {
+        dropped++;
+        return;
+    }
+    float delayMs = config.latencyMs + (Random01() * 2.0f - 1.0f) * config.jitterMs;
+    queues[to].push_back({ packet, now + max(0.0f, delayMs) / 1000.0 });
+}
+
+bool LoopbackTransport::Receive(int at, double now, InputPacket& out) {
+    // Jitter can reorder packets; any arrived one will do, the session keeps order
+    vector<InFlight>& q = queues[at];
+    for (size_t i = 0; i < q.size(); ++i) {
+        if (q[i].deliverAt <= now) {
+            out = q[i].packet;
+            q.erase(q.begin() + i);
+            return true;
+        }
+    }
+    return false;
+}
+
+// -------------------------
+// RollbackSession
+// -------------------------
+
+static const float kSyncWaitTicks = 2.0f;   // lead that makes us skip a tick
+static const float kSyncSmoothing = 0.1f;   // per frame: advantages jitter with the link
+
+void RollbackSession::Start() {
+    ResetGame(current.local);
+    ResetGame(current.remote);
+    tick = 0;
+    confirmedRemote = -1;
+    peerAck = -1;
+    firstWrong = -1;
+    remoteTick = 0;
+    peerAdvantage = 0;
+    lead = 0.0f;
+    syncWait = false;
+    peerCheckTick = -1;
+    peerChecksum = 0;
+    checkedTick = -1;
+    stats = {};
+}
+
+bool RollbackSession::CanAdvance() const {
+    // The snapshot of the oldest unconfirmed tick must survive the next save,
+    // and our oldest unacknowledged input must still be in the history.
+    return tick - (confirmedRemote + 1) < kHistory - 1 && tick - (peerAck + 1) < kInputHistory - 1;
+}
+
+uint8_t RollbackSession::RemoteInputFor(int t) const {
+    if (t <= confirmedRemote) return remoteInputs[t % kInputHistory];
+    // Prediction: the key stays as it was last seen, but a press is an edge and never repeats
+    if (confirmedRemote < 0) return 0;
+    return remoteInputs[confirmedRemote % kInputHistory] & kNetJumpHeld;
+}
+
+const RollbackSession::Frame& RollbackSession::StateBefore(int t) const {
+    return t == tick ? current : snapshots[t % kHistory];
+}
+
+void RollbackSession::Simulate(Frame& frame, const Level& level, uint8_t local, uint8_t remote,
+    GameEvents* localEvents) const {
+    GameEvents scratch;
+    StepGame(frame.local, level, DecodeInput(local), kSimStep, localEvents ? *localEvents : scratch);
+    scratch.count = 0;
+    StepGame(frame.remote, level, DecodeInput(remote), kSimStep, scratch);
+}
+
+bool RollbackSession::Tick(const Level& level, const StepInput& local, GameEvents& localEvents) {
+    if (!CanAdvance()) {
+        stats.stalls++;
+        return false;
+    }
+
+    int slot = tick % kHistory;
+    uint8_t localBits = EncodeInput(local);
+    uint8_t remoteBits = RemoteInputFor(tick);
+
+    snapshots[slot] = current;
+    usedRemote[slot] = remoteBits;
+    localInputs[tick % kInputHistory] = localBits;
+
+    Simulate(current, level, localBits, remoteBits, &localEvents);
+    tick++;
+    return true;
+}
+
+void RollbackSession::Receive(const InputPacket& packet) {
+    peerAck = max(peerAck, packet.ack);
+    // Packets can arrive out of order: the newest one speaks for the remote
+    if (packet.tick >= remoteTick) {
+        remoteTick = packet.tick;
+        peerAdvantage = packet.advantage;
+    }
+    if (packet.checkTick > max(peerCheckTick, checkedTick)) {
+        peerCheckTick = packet.checkTick;
+        peerChecksum = packet.checksum;
+    }
+
+    for (int i = 0; i < packet.count; ++i) {
+        int t = packet.firstTick + i;
+        if (t != confirmedRemote + 1) continue;      // already have it, or a gap before it
+        if (t >= tick + kHistory) break;             // would overwrite inputs still needed
+
+        uint8_t bits = packet.inputs[i];
+        remoteInputs[t % kInputHistory] = bits;
+        confirmedRemote = t;
+
+        // Already simulated with a guess: was the guess right?
+        if (t < tick && bits != usedRemote[t % kHistory]) {
+            firstWrong = firstWrong < 0 ? t : min(firstWrong, t);
+        }
+    }
+}
+
+void RollbackSession::Reconcile(const Level& level) {
+    if (firstWrong >= 0) Resimulate(level);
+    CheckPeer();
+}
+
+void RollbackSession::Resimulate(const Level& level) {
+    chrono::steady_clock::time_point t0 = chrono::steady_clock::now();
+    int depth = tick - firstWrong;
+
+    Frame frame = snapshots[firstWrong % kHistory];
+    for (int t = firstWrong; t < tick; ++t) {
+        int slot = t % kHistory;
+        uint8_t remoteBits = RemoteInputFor(t);
+        snapshots[slot] = frame;
+        usedRemote[slot] = remoteBits;
+        // local events of these ticks were already presented when first simulated
+        Simulate(frame, level, localInputs[t % kInputHistory], remoteBits, nullptr);
+    }
+    current = frame;
+    firstWrong = -1;
+
+    float ms = chrono::duration<float, milli>(chrono::steady_clock::now() - t0).count();
+    stats.rollbacks++;
+    stats.lastDepth = depth;
+    stats.maxDepth = max(stats.maxDepth, depth);
+    stats.resimTicks += depth;
+    stats.lastResimMs = ms;
+    stats.maxResimMs = max(stats.maxResimMs, ms);
+}
+
+void RollbackSession::CheckPeer() {
+    // Our states before tick t are final once we have the peer's inputs up to t - 1
+    int t = peerCheckTick;
+    if (t < 0 || t > confirmedRemote + 1 || t > tick) return;
+    peerCheckTick = -1;
+    checkedTick = t;
+    if (t < tick - kHistory) return; // snapshot already reused
+
+    const Frame& frame = StateBefore(t);
+    uint32_t ours = PairChecksum(frame.remote, frame.local);
+    stats.checks++;
+    if (ours == peerChecksum) return;
+    if (stats.desyncs++ == 0) {
+        TraceLog(LOG_WARNING, "NETPLAY: desync at tick %d (checksum %08x, peer %08x)", t, ours, peerChecksum);
+    }
+}
+
+void RollbackSession::UpdateTimeSync() {
+    float sample = (FrameAdvantage() - peerAdvantage) * 0.5f;
+    lead += (sample - lead) * kSyncSmoothing;
+    // At most one tick per frame. Skipping it takes one tick off our lead,
+    // which the samples only show once the remote has heard about it.
+    syncWait = lead >= kSyncWaitTicks;
+    if (syncWait) lead -= 1.0f;
+}
+
+bool RollbackSession::TakeSyncWait() {
+    if (!syncWait) return false;
+    syncWait = false;
+    stats.syncWaits++;
+    return true;
+}
+
+void RollbackSession::MakePacket(InputPacket& out) const {
+    out.ack = confirmedRemote;
+    out.tick = tick;
+    out.advantage = FrameAdvantage();
+    out.firstTick = max(peerAck + 1, tick - kInputHistory + 1);
+    out.count = min(tick - out.firstTick, kMaxPacketInputs);
+    for (int i = 0; i < out.count; ++i) {
+        out.inputs[i] = localInputs[(out.firstTick + i) % kInputHistory];
+    }
+
+    // A pending misprediction leaves the snapshots after it stale
+    out.checkTick = min(confirmedRemote + 1, tick);
+    if (firstWrong >= 0) out.checkTick = min(out.checkTick, firstWrong);
+    const Frame& frame = StateBefore(out.checkTick);
+    out.checksum = PairChecksum(frame.local, frame.remote);
+}
+
+// -------------------------
+// RaceMatch
+// -------------------------
+
+void RaceMatch::Start(const LinkConfig& config) {
+    link.Configure(config);
+    session.Start();
+    bot.Start();
+}
+
+void RaceMatch::BeginFrame(const Level& level, double now) {
+    InputPacket packet;
+    while (link.Receive(0, now, packet)) session.Receive(packet);
+    while (link.Receive(1, now, packet)) bot.Receive(packet);
+    session.Reconcile(level);
+    bot.Reconcile(level);
+    session.UpdateTimeSync();
+    bot.UpdateTimeSync();
+}
+
+RaceTick RaceMatch::Tick(const Level& level, const StepInput& local, GameEvents& localEvents) {
+    GameEvents botEvents;
+    if (session.TakeSyncWait()) {
+        if (!bot.TakeSyncWait()) bot.Tick(level, BotInput(level), botEvents);
+        return RACE_TICK_WAITED;
+    }
+    if (!session.Tick(level, local, localEvents)) return RACE_TICK_STALLED;
+    if (!bot.TakeSyncWait()) bot.Tick(level, BotInput(level), botEvents);
+    return RACE_TICK_RAN;
+}
+
+void RaceMatch::EndFrame(double now) {
+    InputPacket packet;
+    session.MakePacket(packet);
+    link.Send(1, packet, now);
+    bot.MakePacket(packet);
+    link.Send(0, packet, now);
+}
+
+StepInput RaceMatch::BotInput(const Level& level) const {
+    const GameState& me = bot.Local();
+    StepInput input = { false, false, false };
+    if (!me.alive || me.levelFinished) {
+        input.restart = true;
+        return input;
+    }
+    if (!me.grounded) return input;
+
+    // Jump when a spike on our running surface is just ahead
+    const Rectangle& p = me.player;
+    float lookFrom = p.x + p.width + 8.0f;
+    float lookTo = p.x + p.width + 64.0f;
+    ChunkSpan span = ChunksOverlapping(level.grid, lookFrom, lookTo);
+    for (int c = span.first; c <= span.last && !input.jumpPressed; ++c) {
+        const LevelChunk& chunk = level.grid.chunks[c];
+        for (const auto& run : Items(level.grid.spikes.runs, chunk.spikeRuns)) {
+            const SpikeShape& shape = level.grid.spikes.shapes[run.shape];
+            if (shape.up != (me.gravityDir > 0)) continue; // not on our side
+            for (int i = run.first; i < run.first + run.count && !input.jumpPressed; ++i) {
+                float x = PackedSpikeX(level.grid.spikes, chunk.originX, i);
+                if (x < lookTo && x + shape.width > lookFrom) input.jumpPressed = true;
+            }
+        }
+    }
+    return input;
+}
+
+// -------------------------
+// Headless race check
+// -------------------------
+
+static const int kCheckScreenH = 720;
+static const double kCheckFrameDt = 1.0 / 120.0;
+static const int kCheckStepsPerFrame = kSimHz / 120;
+static const int kCheckHitchEvery = 300;    // frames between the second peer's hitches
+static const int kCheckInputBlock = 24;     // ticks per scripted input decision
+
+// A fixed function of peer and tick, so the reference run sees the same inputs
+static StepInput ScriptedInput(int peer, int t) {
+    uint32_t h = (uint32_t)(t / kCheckInputBlock) * 2654435761u ^ (uint32_t)(peer + 1) * 40503u;
+    h ^= h >> 15;
+    h *= 2246822519u;
+    h ^= h >> 13;
+    int phase = t % kCheckInputBlock;
+    bool jump = h % 3 == 0;
+    StepInput input;
+    input.jumpPressed = jump && phase == 0;
+    input.jumpHeld = jump && phase < (int)(h >> 8) % kCheckInputBlock;
+    input.restart = t % (kSimHz / 2) == 0;
+    return input;
+}
+
+static bool SameState(const char* what, int peer, const GameState& got, const GameState& want) {
+    if (GameChecksum(got) == GameChecksum(want)) return true;
+    printf("  MISMATCH peer %d %s: x %.3f y %.3f alive %d, reference x %.3f y %.3f alive %d\n", peer, what,
+        got.player.x, got.player.y, got.alive, want.player.x, want.player.y, want.alive);
+    return false;
+}
+
+int RunRaceCheck(const RaceCheckOptions& options) {
+    unique_ptr<Level> level = CreateLevel(kCheckScreenH);
+    GameEvents events;
+
+    // Reference: both racers stepped with their true inputs, nothing predicted
+    GameState expected[2];
+    for (int p = 0; p < 2; ++p) ResetGame(expected[p]);
+    for (int t = 0; t < options.ticks; ++t) {
+        for (int p = 0; p < 2; ++p) {
+            events.count = 0;
+            StepGame(expected[p], *level, ScriptedInput(p, t), kSimStep, events);
+        }
+    }
+
+    LoopbackTransport link;
+    link.Configure(options.link);
+    RollbackSession peers[2];
+    peers[0].Start();
+    peers[1].Start();
+
+    // Runs until both peers simulated every tick with every input confirmed
+    int maxFrames = 2 * options.ticks / kCheckStepsPerFrame + 1000;
+    int maxGap = 0;
+    InputPacket packet;
+    for (int frame = 0;; ++frame) {
+        double now = frame * kCheckFrameDt;
+        for (int p = 0; p < 2; ++p) {
+            while (link.Receive(p, now, packet)) peers[p].Receive(packet);
+            peers[p].Reconcile(*level);
+            peers[p].UpdateTimeSync();
+        }
+
+        bool done = true;
+        for (int p = 0; p < 2; ++p) {
+            done = done && peers[p].CurrentTick() == options.ticks && peers[p].ConfirmedRemoteTick() == options.ticks - 1;
+        }
+        if (done) break;
+        if (frame == maxFrames) {
+            printf("  peers stopped at ticks %d and %d, confirmed %d and %d\n", peers[0].CurrentTick(),
+                peers[1].CurrentTick(), peers[0].ConfirmedRemoteTick(), peers[1].ConfirmedRemoteTick());
+            printf("race check: FAIL\n");
+            return 1;
+        }
+
+        for (int p = 0; p < 2; ++p) {
+            if (p == 1 && frame % kCheckHitchEvery == kCheckHitchEvery / 2) continue;
+            for (int i = 0; i < kCheckStepsPerFrame && peers[p].CurrentTick() < options.ticks; ++i) {
+                if (peers[p].TakeSyncWait()) continue;
+                events.count = 0;
+                if (!peers[p].Tick(*level, ScriptedInput(p, peers[p].CurrentTick()), events)) break;
+            }
+        }
+        for (int p = 0; p < 2; ++p) {
+            peers[p].MakePacket(packet);
+            link.Send(1 - p, packet, now);
+        }
+        maxGap = max(maxGap, abs(peers[0].CurrentTick() - peers[1].CurrentTick()));
+    }
+
+    printf("race check: %d ticks, %.0fms latency, %.0fms jitter, %.0f%% loss (%d/%d packets lost)\n", options.ticks,
+        options.link.latencyMs, options.link.jitterMs, options.link.lossRate * 100.0f, link.Dropped(), link.Sent());
+    bool pass = true;
+    for (int p = 0; p < 2; ++p) {
+        const RollbackStats& rb = peers[p].Stats();
+        printf("  peer %d: %d rollbacks (max depth %d), %d stalls, %d sync waits, %d checksums, %d desyncs\n", p,
+            rb.rollbacks, rb.maxDepth, rb.stalls, rb.syncWaits, rb.checks, rb.desyncs);
+        pass = SameState("own racer", p, peers[p].Local(), expected[p]) && pass;
+        pass = SameState("rival", p, peers[p].Remote(), expected[1 - p]) && pass;
+        pass = pass && rb.desyncs == 0 && rb.checks > 0;
+    }
+    printf("  max tick gap between peers %d\n", maxGap);
+    if (peers[0].Stats().rollbacks + peers[1].Stats().rollbacks == 0) {
+        printf("  no rollbacks: the link never made a prediction wrong, so nothing was checked\n");
+        pass = false;
+    }
+    printf("race check: %s\n", pass ? "PASS" : "FAIL");
+    return pass ? 0 : 1;
+}
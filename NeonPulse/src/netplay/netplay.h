@@ -0,0 +1,240 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "../game/game.h"
+#include "../level/level.h"
+
+// -------------------------
+// Rollback netplay
+// -------------------------
+// Two racers run the same level; every peer simulates both cubes in lock
+// step, one StepGame tick per simulation step. Only inputs go over the
+// wire. The remote input for a tick that has not arrived yet is predicted
+// (the jump key keeps its held state, no new press), and when the real
+// input turns out different the session restores the snapshot taken
+// before that tick and re-simulates up to the present.
+//
+// GameState is plain data, so a snapshot is a struct copy. The step is
+// deterministic for a given binary on a given machine: same level, same
+// inputs, same result. Across machines it need not be: StepGame and the
+// platform motion call cosf/sinf, and the MSVC CRT picks FMA or non-FMA
+// versions of those at runtime by CPU. So every packet also carries a
+// checksum of a state both inputs are confirmed for, and the receiver
+// counts a desync when its own state for that tick disagrees.
+// -------------------------
+
+// Input bits as sent on the wire
+const uint8_t kNetJumpPressed = 1;
+const uint8_t kNetJumpHeld = 2;
+const uint8_t kNetRestart = 4;
+
+uint8_t EncodeInput(const StepInput& input);
+StepInput DecodeInput(uint8_t bits);
+
+// FNV-1a over every field's bits (padding excluded)
+uint32_t GameChecksum(const GameState& state);
+
+// -------------------------
+// Transport
+// -------------------------
+
+const int kMaxPacketInputs = 128;
+
+// Unacknowledged inputs are resent in every packet, so a lost packet only
+// costs latency, never an input.
+struct InputPacket {
+    int ack;        // last tick of the receiver's own inputs the sender has, -1 = none
+    int tick;       // the sender's next tick to simulate
+    int advantage;  // the sender's frame advantage (see RollbackSession::FrameAdvantage)
+    int firstTick;  // tick of inputs[0]
+    int count;
+    uint8_t inputs[kMaxPacketInputs];
+    int checkTick;      // the sender's states before this tick are final
+    uint32_t checksum;  // of those states, the sender's racer first
+};
+
+struct LinkConfig {
+    float latencyMs = 60.0f;  // one way
+    float jitterMs = 8.0f;
+    float lossRate = 0.05f;   // 0..1
+    uint32_t seed = 1;
+};
+
+// Stand-in for the network between two endpoints (0 and 1) in one process.
+// Latency, jitter and loss come from a seeded generator, so a run with the
+// same config and timing drops the same packets.
+class LoopbackTransport {
+public:
+    void Configure(const LinkConfig& config);
+    void Send(int to, const InputPacket& packet, double now);
+    // Pops one packet that has arrived at endpoint `at` by `now`.
+    bool Receive(int at, double now, InputPacket& out);
+
+    int Sent() const { return sent; }
+    int Dropped() const { return dropped; }
+
+private:
+    float Random01();
+
+    struct InFlight {
+        InputPacket packet;
+        double deliverAt;
+    };
+
+    LinkConfig config;
+    std::vector<InFlight> queues[2];
+    uint32_t rng = 1;
+    int sent = 0;
+    int dropped = 0;
+};
+
+// -------------------------
+// Session
+// -------------------------
+
+struct RollbackStats {
+    int rollbacks;        // mispredictions corrected
+    int lastDepth;        // ticks re-simulated by the latest rollback
+    int maxDepth;
+    long long resimTicks; // total ticks re-simulated
+    float lastResimMs;
+    float maxResimMs;
+    int stalls;           // ticks held back because the remote fell too far behind
+    int syncWaits;        // ticks skipped to let the remote catch up
+    int checks;           // peer checksums compared against our own states
+    int desyncs;          // ... that disagreed
+};
+
+class RollbackSession {
+public:
+    // Snapshots kept; a rollback can reach this far back (~0.5 s at kSimHz)
+    static const int kHistory = 256;
+
+    void Start();
+
+    // Simulates the next tick with the local input and the remote input
+    // (received or predicted). Events are the local player's only.
+    // Returns false, and counts a stall, when the remote's confirmed input
+    // is so old that another tick would push its snapshot out of the history.
+    bool Tick(const Level& level, const StepInput& local, GameEvents& localEvents);
+
+    void Receive(const InputPacket& packet);
+
+    // Rolls back to the earliest mispredicted tick and re-simulates to
+    // the present, then checks the peer's latest checksum once our own
+    // state for its tick is final. Call once per frame after receiving,
+    // before ticking.
+    void Reconcile(const Level& level);
+
+    // Time sync. Our frame advantage is how many ticks we are ahead of the
+    // remote as last heard from it; the remote reports its own. Half their
+    // difference is how far ahead we really are, latency cancelled out.
+    // Once per frame, after receiving: when that (smoothed) lead reaches
+    // kSyncWaitTicks, the next TakeSyncWait() returns true and the caller
+    // skips one tick, so the remote catches up instead of stalling us.
+    void UpdateTimeSync();
+    bool TakeSyncWait();
+    int FrameAdvantage() const { return tick - remoteTick; }
+
+    void MakePacket(InputPacket& out) const;
+
+    int CurrentTick() const { return tick; }
+    int ConfirmedRemoteTick() const { return confirmedRemote; }
+    const GameState& Local() const { return current.local; }
+    const GameState& Remote() const { return current.remote; }
+    const RollbackStats& Stats() const { return stats; }
+
+private:
+    struct Frame {
+        GameState local;
+        GameState remote;
+    };
+
+    // Inputs are kept twice as long as snapshots: the peer may be ahead of
+    // us, and our own unacknowledged inputs are still being resent.
+    static const int kInputHistory = 2 * kHistory;
+
+    bool CanAdvance() const;
+    uint8_t RemoteInputFor(int t) const;
+    const Frame& StateBefore(int t) const;
+    void Resimulate(const Level& level);
+    void CheckPeer();
+    void Simulate(Frame& frame, const Level& level, uint8_t local, uint8_t remote, GameEvents* localEvents) const;
+
+    Frame current;
+    Frame snapshots[kHistory];          // state before tick t, at t % kHistory
+    uint8_t usedRemote[kHistory];       // remote input tick t was simulated with
+    uint8_t localInputs[kInputHistory];
+    uint8_t remoteInputs[kInputHistory];
+
+    int tick = 0;               // next tick to simulate
+    int confirmedRemote = -1;   // remote inputs are known for every tick up to here
+    int peerAck = -1;           // the peer has our inputs up to here
+    int firstWrong = -1;        // earliest simulated tick whose prediction was wrong
+    int remoteTick = 0;         // the remote's next tick, as of its latest packet
+    int peerAdvantage = 0;      // the remote's frame advantage, as of its latest packet
+    float lead = 0.0f;          // smoothed ticks we are ahead of the remote
+    bool syncWait = false;
+    int peerCheckTick = -1;     // the peer's latest checksum not yet compared
+    uint32_t peerChecksum = 0;
+    int checkedTick = -1;       // latest tick compared
+    RollbackStats stats = {};
+};
+
+// -------------------------
+// Race against a bot over a loopback link
+// -------------------------
+// The bot is a second full peer with its own session, so the local side
+// sees exactly what it would see from a remote player on a bad network.
+// -------------------------
+
+enum RaceTick {
+    RACE_TICK_RAN,      // the local peer advanced one tick
+    RACE_TICK_STALLED,  // neither peer advanced: the remote's inputs are too old
+    RACE_TICK_WAITED,   // the local peer sat this tick out for time sync
+};
+
+class RaceMatch {
+public:
+    void Start(const LinkConfig& config);
+
+    // Delivers packets due by `now`, resolves mispredictions and updates
+    // time sync (both peers).
+    void BeginFrame(const Level& level, double now);
+    // One simulation step for both peers, each waiting on its own view of
+    // the other. Both run off the caller's clock, so when the local peer
+    // stalls the bot does not tick either.
+    RaceTick Tick(const Level& level, const StepInput& local, GameEvents& localEvents);
+    // Sends this frame's inputs (both peers).
+    void EndFrame(double now);
+
+    const GameState& Local() const { return session.Local(); }
+    const GameState& Rival() const { return session.Remote(); }
+    const RollbackSession& Session() const { return session; }
+    const LoopbackTransport& Link() const { return link; }
+
+private:
+    StepInput BotInput(const Level& level) const;
+
+    RollbackSession session;   // endpoint 0, the player
+    RollbackSession bot;       // endpoint 1
+    LoopbackTransport link;
+};
+
+// -------------------------
+// Headless race check
+// -------------------------
+// Two sessions race scripted inputs over a lossy, jittery loopback link on
+// a simulated clock, the second one hitching now and then so time sync has
+// work to do. At the end both must hold exactly the states a plain StepGame
+// run of the same inputs reaches with nothing predicted, and no packet
+// checksum may have disagreed. Needs no window.
+// -------------------------
+
+struct RaceCheckOptions {
+    LinkConfig link;
+    int ticks = 24000;   // per peer (50 s at kSimHz)
+};
+
+// Returns the process exit code: 0 when both peers match the reference run.
+int RunRaceCheck(const RaceCheckOptions& options);
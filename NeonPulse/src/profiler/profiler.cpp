@@ -0,0 +1,31 @@
+#include "profiler.h"
+#include <cstring>
+
+// -------------------------
+// Render profiling counters
+// -------------------------
+
+RenderStats gRenderStats;
+
+int RenderStats::TotalDrawCalls() const {
+    int total = 0;
+    for (const auto& c : categories) total += c.drawCalls;
+    return total;
+}
+
+int RenderStats::TotalVertices() const {
+    int total = 0;
+    for (const auto& c : categories) total += c.vertices;
+    return total;
+}
+
+void ResetRenderStats() {
+    memset(&gRenderStats, 0, sizeof(gRenderStats));
+}
+
+const char* RenderCategoryName(RenderCategory category) {
+    static const char* names[RENDER_CATEGORY_COUNT] = {
+        "background", "rails", "pads", "platforms", "spikes", "particles", "player", "other", "post"
+    };
+    return names[category];
+}
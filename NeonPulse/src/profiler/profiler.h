@@ -0,0 +1,60 @@
+#pragma once
+
+// -------------------------
+// Render profiling counters
+// -------------------------
+// Draw functions report every raylib primitive they submit, tagged with
+// the part of the scene it belongs to. raylib batches internally, so a
+// "draw call" here is one primitive call, not one GPU submission; the
+// counts are for spotting regressions, not for absolute GPU cost.
+// -------------------------
+
+enum RenderCategory {
+    RENDER_BACKGROUND = 0,
+    RENDER_RAILS,
+    RENDER_PADS,
+    RENDER_PLATFORMS,
+    RENDER_SPIKES,
+    RENDER_PARTICLES,
+    RENDER_PLAYER,
+    RENDER_OTHER,
+    RENDER_POST,        // full-screen post passes (bloom)
+    RENDER_CATEGORY_COUNT
+};
+
+// Vertices rlgl emits per primitive (raylib default build, quads draw mode)
+const int kVertsRect = 4;
+const int kVertsTriangle = 4;       // submitted as a degenerate quad
+const int kVertsTriangleLines = 6;
+const int kVertsRectLines = 16;     // DrawRectangleLinesEx: four quads
+const int kVertsCircle = 72;        // 36 segments, two per quad
+const int kVertsCircleLines = 72;
+inline int VertsRoundedRect(int segments) { return 8 * segments + 20; }
+
+struct RenderCounters {
+    int drawCalls;
+    int vertices;
+};
+
+struct RenderStats {
+    RenderCounters categories[RENDER_CATEGORY_COUNT];
+    int blendChanges;
+    float cpuMs;
+
+    int TotalDrawCalls() const;
+    int TotalVertices() const;
+};
+
+extern RenderStats gRenderStats;
+
+inline void CountDraw(RenderCategory category, int vertices) {
+    gRenderStats.categories[category].drawCalls++;
+    gRenderStats.categories[category].vertices += vertices;
+}
+
+inline void CountBlendChange() {
+    gRenderStats.blendChanges++;
+}
+
+void ResetRenderStats();
+const char* RenderCategoryName(RenderCategory category);
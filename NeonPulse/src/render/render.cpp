@@ -0,0 +1,204 @@
+#include "render.h"
+#include "../background/background.h"
+#include "../game/game.h"
+#include "../profiler/profiler.h"
+#include "../utils/utils.h"
+
+using namespace std;
+
+// -------------------------
+// Scene pieces
+// -------------------------
+
+static void DrawRails(const WorldView& view) {
+    // Floor and ceiling rails
+    Color railA = Fade(neonBlue, 0.45f + 0.2f * view.pulse);
+    Color railB = Fade(neonPurple, 0.45f + 0.2f * view.pulse);
+    DrawRectangleGradientH(0, (int)defaultFloorY, view.screenW, 6, railA, railB);
+    DrawRectangleGradientH(0, (int)ceilingYTop - 6, view.screenW, 6, railB, railA);
+    CountDraw(RENDER_RAILS, kVertsRect);
+    CountDraw(RENDER_RAILS, kVertsRect);
+}
+
+static void DrawPads(const ChunkGrid& grid, const LevelChunk& chunk, const WorldView& view) {
+    float camX = view.camX;
+    int screenW = view.screenW;
+
+    // Draw speed pads & jump pads & gravity pads
+    for (const auto& sp : Items(grid.speedPads, chunk.speedPads)) {
+        Rectangle r = UnpackRect(grid, chunk, sp.rect);
+        float x = r.x - camX;
+        if (x + r.width < -120 || x > screenW + 120) continue;
+        DrawRectangle((int)(x), (int)(r.y), (int)r.width, (int)r.height, Fade(grid.palette[sp.color], 0.95f));
+        CountDraw(RENDER_PADS, kVertsRect);
+    }
+    for (const auto& jp : Items(grid.jumpPads, chunk.jumpPads)) {
+        Rectangle r = UnpackRect(grid, chunk, jp.rect);
+        float x = r.x - camX;
+        if (x + r.width < -120 || x > screenW + 120) continue;
+        DrawRectangleRounded({ x, r.y, r.width, r.height }, 0.3f, 6, Fade(grid.palette[jp.color], 0.95f));
+        CountDraw(RENDER_PADS, VertsRoundedRect(6));
+    }
+    for (const auto& gp : Items(grid.gravityPads, chunk.gravityPads)) {
+        Rectangle r = UnpackRect(grid, chunk, gp.rect);
+        float x = r.x - camX;
+        if (x + r.width < -120 || x > screenW + 120) continue;
+
+        // core rectangle (rounded); the glow comes from the bloom pass
+        DrawRectangleRounded({ x, r.y, r.width, r.height }, 0.25f, 6, Fade(grid.palette[gp.color], 0.92f));
+        CountDraw(RENDER_PADS, VertsRoundedRect(6));
+
+        // small icon to suggest flip (triangle up or down)
+        Vector2 center = { x + r.width * 0.5f, r.y + r.height * 0.5f };
+        Vector2 t1, t2, t3;
+
+        if (gp.flipsUp) {
+            // Up arrow: tip at top, base at bottom (works already)
+            t1 = { center.x, center.y - 6.0f };            // top
+            t2 = { center.x - 6.0f, center.y + 6.0f };     // left-bottom
+            t3 = { center.x + 6.0f, center.y + 6.0f };     // right-bottom
+
+            // draw filled triangle + outline
+            DrawTriangle(t1, t2, t3, Fade(WHITE, 0.85f));
+            DrawTriangleLines(t1, t2, t3, Fade(BLACK, 0.25f));
+        }
+        else {
+            // Down arrow: tip at bottom, base at top
+            t1 = { center.x, center.y + 6.0f };            // bottom
+            t2 = { center.x + 6.0f, center.y - 6.0f };     // right-top
+            t3 = { center.x - 6.0f, center.y - 6.0f };     // left-top
+
+            // draw filled triangle + outline
+            DrawTriangle(t1, t2, t3, Fade(WHITE, 0.85f));
+            DrawTriangleLines(t1, t2, t3, Fade(BLACK, 0.25f));
+        }
+        CountDraw(RENDER_PADS, kVertsTriangle);
+        CountDraw(RENDER_PADS, kVertsTriangleLines);
+    }
+}
+
+// rectIndex walks view.platformRects across the visible chunks
+static void DrawPlatforms(const ChunkGrid& grid, const LevelChunk& chunk, const WorldView& view, int& rectIndex) {
+    // Moving platforms
+    for (const auto& p : Items(grid.platforms, chunk.platforms)) {
+        Rectangle r = view.platformRects ? view.platformRects[rectIndex++] : p.GetRect(view.tPhase);
+        if (r.x + r.width - view.camX < -160 || r.x - view.camX > view.screenW + 160) continue;
+        Rectangle drawR = { r.x - view.camX + view.shakeX, r.y + view.shakeY, r.width, r.height };
+        Color fill = Fade(p.color, 0.45f + 0.28f * view.pulse);
+        Color edge = Fade(p.color, 0.96f);
+        DrawRectangleRounded(drawR, 0.18f, 6, fill);
+        DrawRectangleLinesEx(drawR, 3.0f, edge);
+        CountDraw(RENDER_PLATFORMS, VertsRoundedRect(6));
+        CountDraw(RENDER_PLATFORMS, kVertsRectLines);
+    }
+}
+
+static void DrawSpikes(const ChunkGrid& grid, const LevelChunk& chunk, const WorldView& view) {
+    for (const auto& run : Items(grid.spikes.runs, chunk.spikeRuns)) {
+        float width = grid.spikes.shapes[run.shape].width;
+        for (int i = run.first; i < run.first + run.count; ++i) {
+            float x = PackedSpikeX(grid.spikes, chunk.originX, i) - view.camX;
+            if (x + width < -160 || x > view.screenW + 160) continue;
+            DrawSpike(UnpackSpike(grid, chunk, run, i), view.camX);
+        }
+    }
+}
+
+static void DrawParticles(const vector<Particle>& particles, const WorldView& view) {
+    // Particles behind player
+    for (const auto& prt : particles) {
+        Vector2 ppos = { prt.pos.x - view.camX + view.shakeX, prt.pos.y + view.shakeY };
+        DrawCircleV(ppos, prt.size, Fade(prt.color, Clamp1(prt.life * 2.5f, 0.0f, 1.0f)));
+        CountDraw(RENDER_PARTICLES, kVertsCircle);
+    }
+}
+
+static void DrawPlayer(const WorldView& view) {
+    const Rectangle& player = view.player;
+
+    // Drawn once; the halo and the beat glow come from the bloom pass
+    Rectangle drawPlayer = { player.x - view.camX + view.shakeX, player.y + view.shakeY, player.width, player.height };
+    Color playerFill = Fade(neonCyan, view.alive ? 0.92f : 0.28f);
+    Color playerEdge = Fade(neonMagenta, view.alive ? 1.0f : 0.45f);
+    DrawRectangleRounded(drawPlayer, 0.18f, 8, playerFill);
+    DrawRectangleLinesEx(drawPlayer, 3.0f, playerEdge);
+    CountDraw(RENDER_PLAYER, VertsRoundedRect(8));
+    CountDraw(RENDER_PLAYER, kVertsRectLines);
+}
+
+static void DrawRival(const WorldView& view) {
+    // Outline only, so it never hides the local cube
+    const Rectangle& r = *view.rival;
+    Rectangle drawR = { r.x - view.camX + view.shakeX, r.y + view.shakeY, r.width, r.height };
+    DrawRectangleLinesEx(drawR, 3.0f, Fade(neonYellow, view.rivalAlive ? 0.9f : 0.3f));
+    CountDraw(RENDER_PLAYER, kVertsRectLines);
+}
+
+static void DrawFinishLine(const Level& level, const WorldView& view) {
+    // Finish line visual
+    if (level.finishLine.x - view.camX < view.screenW + 200) {
+        DrawRectangle((int)(level.finishLine.x - view.camX), 0, 4, view.screenH, Fade(neonGreen, 0.95f));
+        DrawText("FINISH", (int)(level.finishLine.x - view.camX) + 30, view.screenH / 2 - 12, 20, Fade(WHITE, 0.9f));
+        CountDraw(RENDER_OTHER, kVertsRect);
+        CountDraw(RENDER_OTHER, 6 * kVertsRect);
+    }
+}
+
+// -------------------------
+// World pass
+// -------------------------
+
+ChunkSpan VisibleChunks(const Level& level, float camX, int screenW) {
+    // widest per-entity cull margin used by the pieces above
+    return ChunksOverlapping(level.grid, camX - 160.0f, camX + screenW + 160.0f);
+}
+
+void DrawWorld(const Level& level, const Section& sec, const vector<Particle>& particles,
+    const WorldView& view) {
+    DrawBackground(view.screenW, view.screenH, sec, view.camX, level.layers, level.parallax, view.pulse);
+    DrawRails(view);
+
+    // Entity layers keep their order: all pads, then platforms, then spikes
+    ChunkSpan visible = VisibleChunks(level, view.camX, view.screenW);
+    for (int c = visible.first; c <= visible.last; ++c) DrawPads(level.grid, level.grid.chunks[c], view);
+    int rectIndex = 0;
+    for (int c = visible.first; c <= visible.last; ++c) DrawPlatforms(level.grid, level.grid.chunks[c], view, rectIndex);
+    for (int c = visible.first; c <= visible.last; ++c) DrawSpikes(level.grid, level.grid.chunks[c], view);
+
+    DrawParticles(particles, view);
+    if (view.rival) DrawRival(view);
+    DrawPlayer(view);
+    DrawFinishLine(level, view);
+}
+
+// -------------------------
+// Loading screen
+// -------------------------
+
+void DrawLoadingScreen(int screenW, int screenH, float t, const char* status) {
+    ClearBackground(BLACK);
+    DrawRectangleGradientV(0, 0, screenW, screenH, { 20, 30, 60, 255 }, { 40, 10, 80, 255 });
+    CountDraw(RENDER_BACKGROUND, kVertsRect);
+
+    const char* title = "NEON PULSE";
+    int tw = MeasureText(title, 50);
+    DrawText(title, screenW / 2 - tw / 2, screenH / 3, 50, Fade(neonCyan, 0.95f));
+
+    // A row of cubes lighting up in turn, one per beat
+    const int kCubes = 8;
+    const float kCube = 24.0f;
+    const float kGap = 14.0f;
+    float rowX = screenW * 0.5f - (kCubes * kCube + (kCubes - 1) * kGap) * 0.5f;
+    int lit = (int)(t / secondsPerBeat) % kCubes;
+    float pulse = BeatPulse(t);
+    for (int i = 0; i < kCubes; ++i) {
+        float glow = i == lit ? 0.35f + 0.65f * pulse : 0.2f;
+        float lift = i == lit ? 8.0f * pulse : 0.0f;
+        Rectangle r = { rowX + i * (kCube + kGap), screenH * 0.5f - lift, kCube, kCube };
+        DrawRectangleRounded(r, 0.18f, 6, Fade(i % 2 == 0 ? neonMagenta : neonPurple, glow));
+        CountDraw(RENDER_OTHER, VertsRoundedRect(6));
+    }
+
+    int sw = MeasureText(status, 18);
+    DrawText(status, screenW / 2 - sw / 2, screenH / 2 + 60, 18, Fade(WHITE, 0.6f));
+}
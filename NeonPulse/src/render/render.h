@@ -0,0 +1,43 @@
+#pragma once
+#include "raylib.h"
+#include <vector>
+#include "../entities/entities.h"
+#include "../level/level.h"
+
+// -------------------------
+// World rendering
+// -------------------------
+// Draws everything that lives in world space (background, rails, pads,
+// platforms, spikes, particles, player, finish line). Shared by the game
+// loop and the offscreen render harness; HUD drawing stays with the caller.
+// -------------------------
+
+struct WorldView {
+    int screenW;
+    int screenH;
+    float camX;
+    float shakeX;
+    float shakeY;
+    float pulse;   // beat pulse, 0..1
+    float tPhase;  // moving platform phase time
+    Rectangle player;
+    bool alive;
+    const Rectangle* platformRects; // GetRect results for the platforms of VisibleChunks, in chunk order, or null
+    const Rectangle* rival;         // the other racer's cube, or null
+    bool rivalAlive;
+};
+
+// Chunks that can contribute anything to the frame at camX
+ChunkSpan VisibleChunks(const Level& level, float camX, int screenW);
+
+void DrawWorld(const Level& level, const Section& sec, const std::vector<Particle>& particles,
+    const WorldView& view);
+
+// -------------------------
+// Loading screen
+// -------------------------
+// Shown while the level is prepared; needs nothing but the window, so it
+// can run from the first frame. t is seconds since it first showed.
+// -------------------------
+
+void DrawLoadingScreen(int screenW, int screenH, float t, const char* status);
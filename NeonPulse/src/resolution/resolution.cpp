@@ -0,0 +1,104 @@
+#include "resolution.h"
+#include "../utils/utils.h"
+
+// -------------------------
+// Tuning
+// -------------------------
+
+static const float kMinScale = 0.5f;
+static const float kMaxScale = 1.0f;
+static const float kDropStep = 0.1f;
+static const float kRaiseStep = 0.05f;
+static const float kDropThreshold = 0.9f;   // fraction of the budget
+static const float kRaiseThreshold = 0.65f; // fraction of the budget
+static const float kMissFactor = 1.2f;      // frame time that counts as a missed deadline
+static const int kDropFrames = 6;
+static const int kRaiseFrames = 90;
+static const int kCooldownFrames = 20;
+
+// -------------------------
+// ResolutionScaler
+// -------------------------
+
+void ResolutionScaler::Init(int w, int h, float frameBudget) {
+    screenW = w;
+    screenH = h;
+    budget = frameBudget;
+    scale = kMaxScale;
+    avgCost = 0.0f;
+    overFrames = underFrames = cooldown = 0;
+
+    // Allocated once at full size; lower scales just use the top-left part of it.
+    target = LoadRenderTexture(screenW, screenH);
+    SetTextureFilter(target.texture, TEXTURE_FILTER_BILINEAR);
+}
+
+void ResolutionScaler::Unload() {
+    if (target.id != 0) UnloadRenderTexture(target);
+    target = { 0 };
+}
+
+bool ResolutionScaler::MissedDeadline(float frameTime) const {
+    return frameTime > budget * kMissFactor;
+}
+
+void ResolutionScaler::Update(float frameCost, float frameTime) {
+    // A missed deadline means the GPU (or the driver) is the bottleneck even if
+    // the CPU cost looks fine, so count the whole frame time instead.
+    float sample = MissedDeadline(frameTime) ? frameTime : frameCost;
+    avgCost += (sample - avgCost) * 0.15f;
+
+    if (cooldown > 0) {
+        cooldown--;
+        return;
+    }
+
+    if (avgCost > budget * kDropThreshold) {
+        underFrames = 0;
+        if (++overFrames >= kDropFrames && scale > kMinScale) {
+            scale = Clamp1(scale - kDropStep, kMinScale, kMaxScale);
+            overFrames = 0;
+            cooldown = kCooldownFrames;
+        }
+    }
+    else if (avgCost < budget * kRaiseThreshold) {
+        overFrames = 0;
+        if (++underFrames >= kRaiseFrames && scale < kMaxScale) {
+            scale = Clamp1(scale + kRaiseStep, kMinScale, kMaxScale);
+            underFrames = 0;
+            cooldown = kCooldownFrames;
+        }
+    }
+    else {
+        // inside the hysteresis band: hold the current scale
+        overFrames = 0;
+        underFrames = 0;
+    }
+}
+
+void ResolutionScaler::BeginWorld() {
+    BeginTextureMode(target);
+    ClearBackground(BLACK);
+
+    Camera2D cam = { 0 };
+    cam.zoom = scale;
+    BeginMode2D(cam);
+}
+
+void ResolutionScaler::EndWorld() {
+    EndMode2D();
+    EndTextureMode();
+}
+
+Rectangle ResolutionScaler::WorldSource() const {
+    float w = (float)(int)(screenW * scale);
+    float h = (float)(int)(screenH * scale);
+    // Render textures are stored bottom-up: the region drawn at the top-left of
+    // the pass sits at the top rows of the texture, sampled with a negative height.
+    return { 0.0f, (float)screenH - h, w, -h };
+}
+
+void ResolutionScaler::Present() const {
+    Rectangle dst = { 0.0f, 0.0f, (float)screenW, (float)screenH };
+    DrawTexturePro(target.texture, WorldSource(), dst, { 0.0f, 0.0f }, 0.0f, WHITE);
+}
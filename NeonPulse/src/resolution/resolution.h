@@ -0,0 +1,52 @@
+#pragma once
+#include "raylib.h"
+
+// -------------------------
+// Dynamic resolution scaling
+// -------------------------
+// The world is drawn into an offscreen target at a fraction of the window
+// size and stretched back up, while the HUD stays at native resolution.
+// The fraction follows the measured frame cost with hysteresis: it drops
+// quickly when the budget is blown and recovers slowly once there is headroom.
+// -------------------------
+
+class ResolutionScaler {
+public:
+    void Init(int screenW, int screenH, float frameBudget);
+    void Unload();
+
+    // Feed the CPU cost of the last frame and its total time (GetFrameTime).
+    // Frames that missed their deadline count with their total time.
+    void Update(float frameCost, float frameTime);
+
+    // A frame time past the budget by the miss factor; the HUD counts these.
+    bool MissedDeadline(float frameTime) const;
+
+    // World pass: everything drawn between these lands in the scaled target,
+    // in regular screen coordinates.
+    void BeginWorld();
+    void EndWorld();
+
+    // Stretches the world pass to the window; call inside BeginDrawing().
+    void Present() const;
+
+    // The part of the target holding the current world pass, as a
+    // DrawTexturePro source rect (flipped), for post-processing.
+    Texture2D WorldTexture() const { return target.texture; }
+    Rectangle WorldSource() const;
+
+    float Scale() const { return scale; }
+    float AverageCost() const { return avgCost; }
+
+private:
+    RenderTexture2D target = { 0 };
+    int screenW = 0;
+    int screenH = 0;
+    float budget = 1.0f / 120.0f;
+
+    float scale = 1.0f;
+    float avgCost = 0.0f;
+    int overFrames = 0;   // consecutive frames above the drop threshold
+    int underFrames = 0;  // consecutive frames below the raise threshold
+    int cooldown = 0;     // frames to wait after a change before re-evaluating
+};
@@ -0,0 +1,449 @@
+#include "spatial.h"
+#include "../level/level.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+#include <unordered_set>
+
+using namespace std;
+
+// -------------------------
+// Footprints
+// -------------------------
+
+static void Footprint(const MovingPlatform& p, float& minX, float& maxX) {
+    float travel = p.vertical ? 0.0f : fabsf(p.amplitude);
+    minX = p.base.x - travel;
+    maxX = p.base.x + p.base.width + travel;
+}
+
+static void Footprint(const Rectangle& r, float& minX, float& maxX) {
+    minX = r.x;
+    maxX = r.x + r.width;
+}
+
+static int OwnerChunk(float minX, int count) {
+    int c = (int)floorf(minX / kChunkWidth);
+    return max(0, min(count - 1, c));
+}
+
+// -------------------------
+// Content hashes (FNV-1a over the fields, never over padding)
+// -------------------------
+
+static const uint64_t kHashSeed = 1469598103934665603ull;
+
+static void HashBytes(uint64_t& h, const void* data, size_t size) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        h ^= p[i];
+        h *= 1099511628211ull;
+    }
+}
+
+static void HashFloat(uint64_t& h, float v) { HashBytes(h, &v, sizeof(v)); }
+static void HashColor(uint64_t& h, Color c) { unsigned char b[4] = { c.r, c.g, c.b, c.a }; HashBytes(h, b, 4); }
+static void HashRect(uint64_t& h, const Rectangle& r) { HashFloat(h, r.x); HashFloat(h, r.y); HashFloat(h, r.width); HashFloat(h, r.height); }
+static void HashTag(uint64_t& h, unsigned char tag, bool flag) { unsigned char b[2] = { tag, (unsigned char)flag }; HashBytes(h, b, 2); }
+
+static void HashEntity(uint64_t& h, const MovingPlatform& p) {
+    HashTag(h, 1, p.vertical);
+    HashRect(h, p.base);
+    HashFloat(h, p.amplitude);
+    HashFloat(h, p.speed);
+    HashFloat(h, p.phase);
+    HashColor(h, p.color);
+}
+
+static void HashEntity(uint64_t& h, const Spike& s) {
+    HashTag(h, 2, s.up);
+    HashRect(h, s.base);
+    HashColor(h, s.color);
+}
+
+static void HashEntity(uint64_t& h, const JumpPad& jp) {
+    HashTag(h, 3, false);
+    HashRect(h, jp.rect);
+    HashFloat(h, jp.strength);
+    HashColor(h, jp.color);
+}
+
+static void HashEntity(uint64_t& h, const SpeedPad& sp) {
+    HashTag(h, 4, false);
+    HashRect(h, sp.rect);
+    HashFloat(h, sp.multiplier);
+    HashFloat(h, sp.duration);
+    HashColor(h, sp.color);
+}
+
+static void HashEntity(uint64_t& h, const GravityPad& gp) {
+    HashTag(h, 5, gp.flipsUp);
+    HashRect(h, gp.rect);
+    HashColor(h, gp.color);
+}
+
+// -------------------------
+// Packing
+// -------------------------
+
+static uint32_t FloatBits(float v) {
+    uint32_t bits;
+    memcpy(&bits, &v, sizeof(bits));
+    return bits;
+}
+
+static uint64_t SizeKey(float w, float h) { return (uint64_t)FloatBits(w) << 32 | FloatBits(h); }
+static uint32_t ColorKey(Color c) { return (uint32_t)c.r << 24 | (uint32_t)c.g << 16 | (uint32_t)c.b << 8 | c.a; }
+
+// Calls f(rect, color, kind) for every entity stored packed
+template <typename F>
+static void ForEachPacked(const Level& level, F f) {
+    for (const auto& s : level.spikes) f(s.base, s.color, "spike");
+    for (const auto& jp : level.jumpPads) f(jp.rect, jp.color, "jumppad");
+    for (const auto& sp : level.speedPads) f(sp.rect, sp.color, "speedpad");
+    for (const auto& gp : level.gravityPads) f(gp.rect, gp.color, "gravitypad");
+}
+
+// Whether the colors and pad sizes the level adds to the grid's tables
+// still fit their index types
+static bool TablesHaveRoom(const ChunkGrid& grid, const Level& level) {
+    unordered_set<uint32_t> colors;
+    for (const auto& c : grid.palette) colors.insert(ColorKey(c));
+    unordered_set<uint64_t> sizes;
+    for (const auto& v : grid.padSizes) sizes.insert(SizeKey(v.x, v.y));
+    ForEachPacked(level, [&](const Rectangle& r, Color c, const char* kind) {
+        colors.insert(ColorKey(c));
+        if (strcmp(kind, "spike") != 0) sizes.insert(SizeKey(r.width, r.height));
+    });
+    return colors.size() <= 256 && sizes.size() <= (size_t)UINT16_MAX + 1;
+}
+
+// Looks values up in the grid's shared tables, appending new ones. The
+// lookup maps only live for one UpdateChunkGrid call.
+class GridPacker {
+public:
+    explicit GridPacker(ChunkGrid& g) : grid(g) {
+        for (int i = 0; i < (int)grid.spikes.shapes.size(); ++i) {
+            const SpikeShape& s = grid.spikes.shapes[i];
+            spikeShapes[s.up ? 1 : 0][SizeKey(s.width, s.height)] = i;
+        }
+        for (int i = 0; i < (int)grid.padSizes.size(); ++i) padSizes[SizeKey(grid.padSizes[i].x, grid.padSizes[i].y)] = i;
+        for (int i = 0; i < (int)grid.palette.size(); ++i) colors[ColorKey(grid.palette[i])] = i;
+    }
+
+    int SpikeShapeIndex(float w, float h, bool up) {
+        auto& table = spikeShapes[up ? 1 : 0];
+        auto it = table.find(SizeKey(w, h));
+        if (it != table.end()) return it->second;
+        int index = (int)grid.spikes.shapes.size();
+        grid.spikes.shapes.push_back(MakeSpikeShape(w, h, up));
+        table[SizeKey(w, h)] = index;
+        return index;
+    }
+
+    uint8_t ColorIndex(Color c) {
+        auto it = colors.find(ColorKey(c));
+        if (it != colors.end()) return (uint8_t)it->second;
+        if (grid.palette.size() < 256) {
+            int index = (int)grid.palette.size();
+            grid.palette.push_back(c);
+            colors[ColorKey(c)] = index;
+            return (uint8_t)index;
+        }
+        // Palette full (only for levels LevelFitsChunkGrid rejects): the closest color already in it
+        int best = 0, bestDist = INT32_MAX;
+        for (int i = 0; i < (int)grid.palette.size(); ++i) {
+            const Color& p = grid.palette[i];
+            int dr = p.r - c.r, dg = p.g - c.g, db = p.b - c.b, da = p.a - c.a;
+            int dist = dr * dr + dg * dg + db * db + da * da;
+            if (dist < bestDist) {
+                bestDist = dist;
+                best = i;
+            }
+        }
+        return (uint8_t)best;
+    }
+
+    PackedRect Rect(const LevelChunk& chunk, const Rectangle& r) {
+        bool cx, cy;
+        PackedRect out;
+        out.x = QuantizeCoord(r.x - chunk.originX, &cx);
+        out.y = QuantizeCoord(r.y, &cy);
+        out.size = PadSizeIndex(r.width, r.height);
+        if (cx || cy) clamped++;
+        return out;
+    }
+
+    // Appends to the chunk's runs, which must be the last ones in the grid
+    void AddSpike(LevelChunk& chunk, const Spike& s) {
+        PackedSpikes& spikes = grid.spikes;
+        bool cx, cy;
+        int shape = SpikeShapeIndex(s.base.width, s.base.height, s.up);
+        int index = (int)spikes.color.size();
+        int16_t x = QuantizeCoord(s.base.x - chunk.originX, &cx);
+        spikes.x.push_back(x);
+        spikes.y.push_back(QuantizeCoord(s.base.y, &cy));
+        spikes.color.push_back(ColorIndex(s.color));
+        if (cx || cy) clamped++;
+
+        if (chunk.spikeRuns.count > 0 && spikes.runs.back().shape == shape) {
+            SpikeRun& run = spikes.runs.back();
+            run.count++;
+            run.minX = min(run.minX, x);
+            run.maxX = max(run.maxX, x);
+        }
+        else {
+            spikes.runs.push_back({ index, 1, shape, x, x });
+            chunk.spikeRuns.count++;
+        }
+    }
+
+    int Clamped() const { return clamped; }
+
+private:
+    uint16_t PadSizeIndex(float w, float h) {
+        auto it = padSizes.find(SizeKey(w, h));
+        if (it != padSizes.end()) return (uint16_t)it->second;
+        if (grid.padSizes.size() > UINT16_MAX) return 0; // never in practice; keeps the index in range
+        int index = (int)grid.padSizes.size();
+        grid.padSizes.push_back({ w, h });
+        padSizes[SizeKey(w, h)] = index;
+        return (uint16_t)index;
+    }
+
+    ChunkGrid& grid;
+    unordered_map<uint64_t, int> spikeShapes[2]; // down, up
+    unordered_map<uint64_t, int> padSizes;
+    unordered_map<uint32_t, int> colors;
+    int clamped = 0;
+};
+
+// Entity indices grouped by owner chunk, list order kept inside a chunk:
+// chunk c owns order[start[c] .. start[c + 1])
+template <typename List, typename MinX>
+static void GroupByChunk(const List& list, int count, MinX minX, vector<int>& start, vector<int>& order) {
+    start.assign((size_t)count + 1, 0);
+    for (const auto& e : list) start[OwnerChunk(minX(e), count) + 1]++;
+    for (int c = 0; c < count; ++c) start[c + 1] += start[c];
+    vector<int> next(start.begin(), start.end() - 1);
+    order.resize(list.size());
+    for (int i = 0; i < (int)list.size(); ++i) order[next[OwnerChunk(minX(list[i]), count)]++] = i;
+}
+
+template <typename T>
+static ChunkRange CopyRange(vector<T>& to, const vector<T>& from, ChunkRange range) {
+    ChunkRange moved = { (uint32_t)to.size(), range.count };
+    to.insert(to.end(), from.begin() + range.first, from.begin() + range.first + range.count);
+    return moved;
+}
+
+static ChunkRange CopySpikeRuns(PackedSpikes& to, const PackedSpikes& from, ChunkRange runs) {
+    ChunkRange moved = { (uint32_t)to.runs.size(), runs.count };
+    for (uint32_t r = runs.first; r < runs.first + runs.count; ++r) {
+        SpikeRun run = from.runs[r];
+        int first = run.first;
+        run.first = (int)to.color.size();
+        to.x.insert(to.x.end(), from.x.begin() + first, from.x.begin() + first + run.count);
+        to.y.insert(to.y.end(), from.y.begin() + first, from.y.begin() + first + run.count);
+        to.color.insert(to.color.end(), from.color.begin() + first, from.color.begin() + first + run.count);
+        to.runs.push_back(run);
+    }
+    return moved;
+}
+
+// -------------------------
+// Grid
+// -------------------------
+
+ChunkSpan ChunksOverlapping(const ChunkGrid& grid, float x0, float x1) {
+    int count = (int)grid.chunks.size();
+    if (count == 0) return { 0, -1 };
+    int first = (int)floorf((x0 - grid.maxSpan) / kChunkWidth);
+    int last = (int)floorf(x1 / kChunkWidth);
+    return { max(0, first), min(count - 1, last) };
+}
+
+// Sizes the grid to the furthest reach of any entity
+static int ChunkCount(const Level& level, float& maxSpan) {
+    float levelEnd = level.finishLine.x + level.finishLine.width;
+    maxSpan = 0.0f;
+    float minX, maxX;
+    auto measure = [&](float a, float b) {
+        levelEnd = max(levelEnd, b);
+        maxSpan = max(maxSpan, b - a);
+    };
+    for (const auto& p : level.platforms) { Footprint(p, minX, maxX); measure(minX, maxX); }
+    for (const auto& s : level.spikes) { Footprint(s.base, minX, maxX); measure(minX, maxX); }
+    for (const auto& jp : level.jumpPads) { Footprint(jp.rect, minX, maxX); measure(minX, maxX); }
+    for (const auto& sp : level.speedPads) { Footprint(sp.rect, minX, maxX); measure(minX, maxX); }
+    for (const auto& gp : level.gravityPads) { Footprint(gp.rect, minX, maxX); measure(minX, maxX); }
+    return (int)(max(levelEnd, 0.0f) / kChunkWidth) + 1;
+}
+
+bool LevelFitsChunkGrid(const Level& level) {
+    float maxSpan;
+    int count = ChunkCount(level, maxSpan);
+    int outside = 0;
+    ForEachPacked(level, [&](const Rectangle& r, Color, const char* kind) {
+        bool cx, cy;
+        QuantizeCoord(r.x - OwnerChunk(r.x, count) * kChunkWidth, &cx);
+        QuantizeCoord(r.y, &cy);
+        if ((cx || cy) && outside++ == 0) {
+            TraceLog(LOG_WARNING, "LEVEL: %s at (%.1f, %.1f) is outside the packed coordinate range", kind, r.x, r.y);
+        }
+    });
+    if (outside > 1) TraceLog(LOG_WARNING, "LEVEL: %d entities outside the packed coordinate range", outside);
+
+    bool roomy = TablesHaveRoom(ChunkGrid(), level);
+    if (!roomy) TraceLog(LOG_WARNING, "LEVEL: more than 256 colors or 65536 pad sizes on packed entities");
+    return outside == 0 && roomy;
+}
+
+int UpdateChunkGrid(ChunkGrid& grid, const Level& level, int chunkLimit, const atomic<bool>* cancel) {
+    // The tables only grow, so carried-over chunks keep their indices. When
+    // the level brings more new entries than there is room for, everything
+    // is packed again from empty tables.
+    if (!TablesHaveRoom(grid, level)) grid = ChunkGrid();
+
+    float maxSpan;
+    int count = ChunkCount(level, maxSpan);
+    grid.maxSpan = maxSpan;
+    float minX, maxX;
+
+    // Hash what each chunk should contain, in list order
+    vector<uint64_t> hashes((size_t)count, kHashSeed);
+    for (const auto& p : level.platforms) { Footprint(p, minX, maxX); HashEntity(hashes[OwnerChunk(minX, count)], p); }
+    for (const auto& s : level.spikes) HashEntity(hashes[OwnerChunk(s.base.x, count)], s);
+    for (const auto& jp : level.jumpPads) HashEntity(hashes[OwnerChunk(jp.rect.x, count)], jp);
+    for (const auto& sp : level.speedPads) HashEntity(hashes[OwnerChunk(sp.rect.x, count)], sp);
+    for (const auto& gp : level.gravityPads) HashEntity(hashes[OwnerChunk(gp.rect.x, count)], gp);
+
+    // Only chunks whose contents changed are packed again; the others are
+    // carried over as they are
+    int previousCount = (int)grid.chunks.size();
+    grid.chunks.resize((size_t)count);
+    vector<char> dirty((size_t)count, 0);
+    int rebuilt = 0;
+    for (int c = 0; c < count; ++c) {
+        LevelChunk& chunk = grid.chunks[c];
+        if (c >= chunkLimit) {
+            // Hash 0 never matches a real one, so the next call packs it
+            chunk = LevelChunk();
+            chunk.originX = c * kChunkWidth;
+            continue;
+        }
+        if (chunk.hash == hashes[c]) continue;
+        chunk.hash = hashes[c];
+        chunk.originX = c * kChunkWidth;
+        dirty[c] = 1;
+        rebuilt++;
+    }
+    if (rebuilt == 0 && count == previousCount) return 0;
+
+    vector<int> platformStart, platformOrder, spikeStart, spikeOrder;
+    vector<int> jumpStart, jumpOrder, speedStart, speedOrder, gravityStart, gravityOrder;
+    GroupByChunk(level.platforms, count, [](const MovingPlatform& p) {
+        float lo, hi;
+        Footprint(p, lo, hi);
+        return lo;
+    }, platformStart, platformOrder);
+    GroupByChunk(level.spikes, count, [](const Spike& s) { return s.base.x; }, spikeStart, spikeOrder);
+    GroupByChunk(level.jumpPads, count, [](const JumpPad& jp) { return jp.rect.x; }, jumpStart, jumpOrder);
+    GroupByChunk(level.speedPads, count, [](const SpeedPad& sp) { return sp.rect.x; }, speedStart, speedOrder);
+    GroupByChunk(level.gravityPads, count, [](const GravityPad& gp) { return gp.rect.x; }, gravityStart, gravityOrder);
+
+    // Rebuild the shared arrays chunk by chunk, in chunk order
+    ChunkGrid old;
+    old.platforms.swap(grid.platforms);
+    old.spikes.x.swap(grid.spikes.x);
+    old.spikes.y.swap(grid.spikes.y);
+    old.spikes.color.swap(grid.spikes.color);
+    old.spikes.runs.swap(grid.spikes.runs);
+    old.jumpPads.swap(grid.jumpPads);
+    old.speedPads.swap(grid.speedPads);
+    old.gravityPads.swap(grid.gravityPads);
+
+    GridPacker pack(grid);
+    for (int c = 0; c < count; ++c) {
+        if (cancel && cancel->load(memory_order_relaxed)) return -1;
+        LevelChunk& chunk = grid.chunks[c];
+        if (!dirty[c]) {
+            chunk.platforms = CopyRange(grid.platforms, old.platforms, chunk.platforms);
+            chunk.jumpPads = CopyRange(grid.jumpPads, old.jumpPads, chunk.jumpPads);
+            chunk.speedPads = CopyRange(grid.speedPads, old.speedPads, chunk.speedPads);
+            chunk.gravityPads = CopyRange(grid.gravityPads, old.gravityPads, chunk.gravityPads);
+            chunk.spikeRuns = CopySpikeRuns(grid.spikes, old.spikes, chunk.spikeRuns);
+            continue;
+        }
+
+        chunk.platforms = { (uint32_t)grid.platforms.size(), 0 };
+        for (int i = platformStart[c]; i < platformStart[c + 1]; ++i) {
+            grid.platforms.push_back(level.platforms[platformOrder[i]]);
+            chunk.platforms.count++;
+        }
+        chunk.spikeRuns = { (uint32_t)grid.spikes.runs.size(), 0 };
+        for (int i = spikeStart[c]; i < spikeStart[c + 1]; ++i) pack.AddSpike(chunk, level.spikes[spikeOrder[i]]);
+
+        chunk.jumpPads = { (uint32_t)grid.jumpPads.size(), (uint32_t)(jumpStart[c + 1] - jumpStart[c]) };
+        for (int i = jumpStart[c]; i < jumpStart[c + 1]; ++i) {
+            const JumpPad& jp = level.jumpPads[jumpOrder[i]];
+            grid.jumpPads.push_back({ pack.Rect(chunk, jp.rect), pack.ColorIndex(jp.color), jp.strength });
+        }
+        chunk.speedPads = { (uint32_t)grid.speedPads.size(), (uint32_t)(speedStart[c + 1] - speedStart[c]) };
+        for (int i = speedStart[c]; i < speedStart[c + 1]; ++i) {
+            const SpeedPad& sp = level.speedPads[speedOrder[i]];
+            grid.speedPads.push_back({ pack.Rect(chunk, sp.rect), pack.ColorIndex(sp.color), sp.multiplier, sp.duration });
+        }
+        chunk.gravityPads = { (uint32_t)grid.gravityPads.size(), (uint32_t)(gravityStart[c + 1] - gravityStart[c]) };
+        for (int i = gravityStart[c]; i < gravityStart[c + 1]; ++i) {
+            const GravityPad& gp = level.gravityPads[gravityOrder[i]];
+            grid.gravityPads.push_back({ pack.Rect(chunk, gp.rect), pack.ColorIndex(gp.color), gp.flipsUp });
+        }
+    }
+    PadPackedSpikes(grid.spikes);
+
+    grid.platforms.shrink_to_fit();
+    grid.spikes.x.shrink_to_fit();
+    grid.spikes.y.shrink_to_fit();
+    grid.spikes.color.shrink_to_fit();
+    grid.spikes.runs.shrink_to_fit();
+    grid.jumpPads.shrink_to_fit();
+    grid.speedPads.shrink_to_fit();
+    grid.gravityPads.shrink_to_fit();
+
+    if (pack.Clamped() > 0) {
+        TraceLog(LOG_WARNING, "LEVEL: %d entities outside the packed coordinate range were clamped (see LevelFitsChunkGrid)", pack.Clamped());
+    }
+    return rebuilt;
+}
+
+// -------------------------
+// Decoding
+// -------------------------
+
+Rectangle UnpackRect(const ChunkGrid& grid, const LevelChunk& chunk, const PackedRect& r) {
+    const Vector2& size = grid.padSizes[r.size];
+    return { chunk.originX + r.x * kCoordStep, r.y * kCoordStep, size.x, size.y };
+}
+
+Spike UnpackSpike(const ChunkGrid& grid, const LevelChunk& chunk, const SpikeRun& run, int i) {
+    const SpikeShape& shape = grid.spikes.shapes[run.shape];
+    Rectangle base = { PackedSpikeX(grid.spikes, chunk.originX, i), PackedSpikeY(grid.spikes, i), shape.width, shape.height };
+    return { base, shape.up, grid.palette[grid.spikes.color[i]] };
+}
+
+int FirstSpikeHit(const ChunkGrid& grid, const LevelChunk& chunk, const Rectangle& player) {
+    return FirstSpikeHit(grid.spikes, (int)chunk.spikeRuns.first, (int)chunk.spikeRuns.count, chunk.originX, player);
+}
+
+template <typename T>
+static size_t VectorBytes(const vector<T>& v) { return v.capacity() * sizeof(T); }
+
+size_t ChunkGridBytes(const ChunkGrid& grid) {
+    const PackedSpikes& s = grid.spikes;
+    return VectorBytes(grid.chunks) + VectorBytes(grid.platforms) +
+        VectorBytes(s.shapes) + VectorBytes(s.x) + VectorBytes(s.y) + VectorBytes(s.color) + VectorBytes(s.runs) +
+        VectorBytes(grid.jumpPads) + VectorBytes(grid.speedPads) + VectorBytes(grid.gravityPads) +
+        VectorBytes(grid.padSizes) + VectorBytes(grid.palette);
+}
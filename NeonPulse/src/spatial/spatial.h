@@ -0,0 +1,140 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "../entities/entities.h"
+#include "../collision/collision.h"
+
+// -------------------------
+// Chunk grid
+// -------------------------
+// Collision and drawing look entities up by world x through fixed-width
+// chunks instead of walking every list. Each entity lives in exactly one
+// chunk (the one holding its leftmost reach), so a query widens its range
+// by the widest footprint rather than storing entities twice.
+//
+// Each chunk keeps a hash of its contents; UpdateChunkGrid only refills the
+// chunks whose hash changed, which is what makes level hot-reload cheap.
+//
+// Entities are stored packed (see collision.h) in arrays shared by the
+// whole grid, each chunk owning one contiguous range per kind: 16-bit
+// positions relative to the chunk, sizes and colors as indices into
+// shared tables. Positions snap to kCoordStep; sizes are kept exact.
+// Platforms stay full structs: there are few, and their motion needs the
+// floats.
+// -------------------------
+
+struct Level;
+
+const float kChunkWidth = 512.0f;
+
+// Position in kCoordStep units from the chunk origin (y absolute), size
+// from ChunkGrid::padSizes
+struct PackedRect {
+    int16_t x;
+    int16_t y;
+    uint16_t size;
+};
+
+struct PackedJumpPad {
+    PackedRect rect;
+    uint8_t color; // ChunkGrid::palette index, as for all packed entities
+    float strength;
+};
+
+struct PackedSpeedPad {
+    PackedRect rect;
+    uint8_t color;
+    float multiplier;
+    float duration;
+};
+
+struct PackedGravityPad {
+    PackedRect rect;
+    uint8_t color;
+    bool flipsUp;
+};
+
+// A chunk's share of one of the grid's entity arrays
+struct ChunkRange {
+    uint32_t first;
+    uint32_t count;
+};
+
+struct LevelChunk {
+    uint64_t hash = 0;
+    float originX = 0.0f;
+    ChunkRange platforms = {};
+    ChunkRange spikeRuns = {};
+    ChunkRange jumpPads = {};
+    ChunkRange speedPads = {};
+    ChunkRange gravityPads = {};
+};
+
+struct ChunkGrid {
+    std::vector<LevelChunk> chunks;
+    float maxSpan = 0.0f; // widest entity footprint, platform travel included
+
+    std::vector<MovingPlatform> platforms;
+    PackedSpikes spikes;
+    std::vector<PackedJumpPad> jumpPads;
+    std::vector<PackedSpeedPad> speedPads;
+    std::vector<PackedGravityPad> gravityPads;
+
+    // Only ever appended to, so indices stay valid for the chunks a
+    // hot-reload does not rebuild
+    std::vector<Vector2> padSizes;
+    std::vector<Color> palette; // at most 256 (see LevelFitsChunkGrid)
+};
+
+// Range-for over a chunk's entities: for (const auto& jp : Items(grid.jumpPads, chunk.jumpPads))
+template <typename T>
+struct ChunkItems {
+    const T* first;
+    const T* last;
+    const T* begin() const { return first; }
+    const T* end() const { return last; }
+};
+
+template <typename T>
+ChunkItems<T> Items(const std::vector<T>& all, ChunkRange range) {
+    return { all.data() + range.first, all.data() + range.first + range.count };
+}
+
+// Inclusive chunk index range; empty when last < first
+struct ChunkSpan {
+    int first;
+    int last;
+};
+
+// Chunks that may hold entities overlapping world x range [x0, x1]
+ChunkSpan ChunksOverlapping(const ChunkGrid& grid, float x0, float x1);
+
+// Whether every packed entity keeps its place and color: positions within
+// the int16 range of their chunk, at most 256 colors and 65536 pad sizes.
+// Logs what does not fit. Level files that fail this are rejected, since
+// packing would clamp positions and remap colors.
+bool LevelFitsChunkGrid(const Level& level);
+
+// Brings the grid in line with the level's entity lists and returns how
+// many chunks had to be rebuilt. Chunks from chunkLimit on are left empty
+// and unhashed, so a later call without a limit fills in just those; this
+// is how startup gets the opening chunks playable first. Once *cancel is
+// set the call gives up between chunks and returns -1, leaving a grid that
+// is only good for throwing away.
+int UpdateChunkGrid(ChunkGrid& grid, const Level& level, int chunkLimit = INT32_MAX,
+    const std::atomic<bool>* cancel = nullptr);
+
+// -------------------------
+// Decoding
+// -------------------------
+
+Rectangle UnpackRect(const ChunkGrid& grid, const LevelChunk& chunk, const PackedRect& r);
+// Spike i of the grid; run is the one holding it, in the chunk's range
+Spike UnpackSpike(const ChunkGrid& grid, const LevelChunk& chunk, const SpikeRun& run, int i);
+// First spike of the chunk touching the player, or -1
+int FirstSpikeHit(const ChunkGrid& grid, const LevelChunk& chunk, const Rectangle& player);
+
+// Heap bytes held by the grid: chunks, their entity arrays and the tables
+size_t ChunkGridBytes(const ChunkGrid& grid);
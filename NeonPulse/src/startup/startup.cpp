@@ -0,0 +1,156 @@
+#include "startup.h"
+#include "raylib.h"
+#include <algorithm>
+#include <chrono>
+
+using namespace std;
+
+// -------------------------
+// StartupProfiler
+// -------------------------
+
+// Initialized with the other statics, before main runs
+static const chrono::steady_clock::time_point gLaunchTime = chrono::steady_clock::now();
+
+double StartupProfiler::Now() {
+    return chrono::duration<double>(chrono::steady_clock::now() - gLaunchTime).count();
+}
+
+StartupProfiler::StartupProfiler() : mainThread(this_thread::get_id()), mainEntry(Now()) {}
+
+void StartupProfiler::Record(const char* name, double start, double end) {
+    lock_guard<mutex> lock(phasesMutex);
+    phases.push_back({ name, start, end, this_thread::get_id() });
+}
+
+void StartupProfiler::MarkFirstFrame() {
+    if (firstFrame < 0.0) firstFrame = Now();
+}
+
+void StartupProfiler::MarkPlayable() {
+    if (playable < 0.0) playable = Now();
+}
+
+void StartupProfiler::Report() const {
+    vector<Phase> sorted;
+    {
+        lock_guard<mutex> lock(phasesMutex);
+        sorted = phases;
+    }
+    sort(sorted.begin(), sorted.end(), [](const Phase& a, const Phase& b) { return a.start < b.start; });
+
+    TraceLog(LOG_INFO, "STARTUP: %-24s %-9s %9s %9s", "phase", "thread", "start ms", "ms");
+    TraceLog(LOG_INFO, "STARTUP: %-24s %-9s %9.1f %9.1f", "runtime init", "main", 0.0, mainEntry * 1000.0);
+    vector<thread::id> threads = { mainThread };
+    for (const auto& p : sorted) {
+        int t = (int)(find(threads.begin(), threads.end(), p.thread) - threads.begin());
+        if (t == (int)threads.size()) threads.push_back(p.thread);
+        TraceLog(LOG_INFO, "STARTUP: %-24s %-9s %9.1f %9.1f", p.name, t == 0 ? "main" : TextFormat("worker %d", t),
+            p.start * 1000.0, (p.end - p.start) * 1000.0);
+    }
+    TraceLog(LOG_INFO, "STARTUP: time-to-first-frame %.1fms, time-to-playable %.1fms", firstFrame * 1000.0, playable * 1000.0);
+}
+
+// -------------------------
+// LevelPrep
+// -------------------------
+
+LevelPrep::~LevelPrep() {
+    cancel = true;
+    if (gridReady.valid()) gridReady.wait();
+}
+
+void LevelPrep::Start(const string& levelPath, int screenH, StartupProfiler& profiler) {
+    levelReady = firstChunks.get_future();
+    gridReady = async(launch::async, &LevelPrep::Run, this, levelPath, screenH, &profiler);
+}
+
+ChunkGrid LevelPrep::Run(string levelPath, int screenH, StartupProfiler* profiler) {
+    bool handedOver = false;
+    try {
+        unique_ptr<Level> level(new Level());
+        {
+            status = "reading level";
+            StartupPhase phase(*profiler, levelPath.empty() ? "level layout" : "level file");
+            bool exists = !levelPath.empty() && FileExists(levelPath.c_str());
+            bool parsed = exists && ParseLevelFile(*level, levelPath.c_str());
+            if (!parsed) {
+                if (exists) level.reset(new Level());
+                BuildLevelLayout(*level, screenH);
+                if (!levelPath.empty() && !exists) SaveLevelFile(*level, levelPath.c_str());
+            }
+        }
+        if (cancel) return ChunkGrid();
+
+        // The parallax field only reads the layers: build it next to the grid
+        const Level& lists = *level;
+        ParallaxField* parallax = &level->parallax;
+        future<void> parallaxReady = async(launch::async, [&lists, parallax, profiler] {
+            StartupPhase phase(*profiler, "parallax field");
+            BuildParallaxField(*parallax, lists.layers);
+        });
+
+        ChunkGrid grid;
+        {
+            status = "packing the opening chunks";
+            StartupPhase phase(*profiler, "grid: first chunks");
+            UpdateChunkGrid(level->grid, *level, kFirstChunks);
+            grid = level->grid;
+        }
+        parallaxReady.get();
+        firstChunks.set_value(move(level));
+        handedOver = true;
+        if (cancel) return ChunkGrid();
+
+        // The main thread owns the level now but keeps it alive and unchanged
+        // until this grid is swapped in, so its lists can still be read here
+        {
+            status = "packing the rest of the level";
+            StartupPhase phase(*profiler, "grid: remaining chunks");
+            UpdateChunkGrid(grid, lists, INT32_MAX, &cancel);
+        }
+        status = "ready";
+        return grid;
+    } catch (...) {
+        status = "failed";
+        if (!handedOver) firstChunks.set_exception(current_exception());
+        throw;
+    }
+}
+
+// Logs what the worker threw
+static void ReportPrepFailure(exception_ptr error) {
+    try {
+        rethrow_exception(error);
+    } catch (const exception& e) {
+        TraceLog(LOG_ERROR, "STARTUP: level preparation failed: %s", e.what());
+    } catch (...) {
+        TraceLog(LOG_ERROR, "STARTUP: level preparation failed");
+    }
+}
+
+bool LevelPrep::TakeLevel(unique_ptr<Level>& level) {
+    if (!levelReady.valid() || levelReady.wait_for(chrono::seconds(0)) != future_status::ready) return false;
+    try {
+        level = levelReady.get();
+    } catch (...) {
+        ReportPrepFailure(current_exception());
+        failed = true;
+    }
+    return true;
+}
+
+bool LevelPrep::FinishGrid(Level& level) {
+    if (complete || failed || !gridReady.valid() || gridReady.wait_for(chrono::seconds(0)) != future_status::ready) return false;
+    try {
+        level.grid = gridReady.get();
+    } catch (...) {
+        ReportPrepFailure(current_exception());
+        failed = true;
+        return false;
+    }
+    // The workers are done with the lists and the grid has every entity now
+    ReleaseEntityLists(level);
+    complete = true;
+    return true;
+}
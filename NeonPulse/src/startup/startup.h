@@ -0,0 +1,124 @@
+#pragma once
+#include <atomic>
+#include <cfloat>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../level/level.h"
+
+// -------------------------
+// Startup profiling
+// -------------------------
+// Times every startup phase from process launch, on whichever thread runs
+// it, plus two milestones: time-to-first-frame (the first frame presented,
+// loading screen included) and time-to-playable (the first frame the
+// simulation runs on). The report is logged once both are known and the
+// level is fully prepared.
+// -------------------------
+
+class StartupProfiler {
+public:
+    StartupProfiler();
+
+    // Seconds since launch
+    static double Now();
+
+    // Thread-safe
+    void Record(const char* name, double start, double end);
+
+    // Only the first call counts
+    void MarkFirstFrame();
+    void MarkPlayable();
+    bool Playable() const { return playable >= 0.0; }
+
+    void Report() const;
+
+private:
+    struct Phase {
+        const char* name;
+        double start;
+        double end;
+        std::thread::id thread;
+    };
+
+    mutable std::mutex phasesMutex;
+    std::vector<Phase> phases;
+    std::thread::id mainThread;
+    double mainEntry;
+    double firstFrame = -1.0;
+    double playable = -1.0;
+};
+
+// Records the enclosing scope: StartupPhase phase(profiler, "window");
+class StartupPhase {
+public:
+    StartupPhase(StartupProfiler& profiler, const char* name)
+        : profiler(profiler), name(name), start(StartupProfiler::Now()) {}
+    ~StartupPhase() { profiler.Record(name, start, StartupProfiler::Now()); }
+
+private:
+    StartupProfiler& profiler;
+    const char* name;
+    double start;
+};
+
+// -------------------------
+// Level preparation
+// -------------------------
+// Builds the level on worker threads while the main thread opens the
+// window and shows the loading screen. Once the entity lists are filled,
+// the parallax field and the chunk grid are built side by side, the grid
+// in two steps: the first kFirstChunks chunks, which is when the level is
+// handed over, then the rest into a separate grid that the main thread
+// swaps in between frames.
+//
+// Until then the handed-over level must not be replaced (no hot-reload)
+// and gameplay has to stay below ReadyX.
+//
+// A worker that throws (out of memory, say) fails the preparation: it is
+// logged, TakeLevel or FinishGrid report it through Failed(), and the
+// caller gives up on the run. Destroying a LevelPrep cancels the workers
+// between phases and chunks instead of waiting for the whole level.
+// -------------------------
+
+class LevelPrep {
+public:
+    static const int kFirstChunks = 8;
+
+    ~LevelPrep(); // cancels the workers and waits for them
+
+    // levelPath may be empty (built-in level). A missing file is seeded with
+    // the built-in level; one that fails to parse falls back to it.
+    void Start(const std::string& levelPath, int screenH, StartupProfiler& profiler);
+
+    // Main thread. True once, when the first chunks are in: moves the level
+    // out. Also true, with level left empty, when preparation failed.
+    bool TakeLevel(std::unique_ptr<Level>& level);
+
+    // Main thread, between frames. True once, when the remaining chunks have
+    // been swapped into level's grid.
+    bool FinishGrid(Level& level);
+
+    bool Complete() const { return complete; }
+    bool Failed() const { return failed; }
+
+    // World x below which the handed-over grid holds every entity
+    float ReadyX() const { return complete ? FLT_MAX : kFirstChunks * kChunkWidth; }
+
+    // What the workers are doing, for the loading screen
+    const char* Status() const { return status.load(); }
+
+private:
+    ChunkGrid Run(std::string levelPath, int screenH, StartupProfiler* profiler);
+
+    std::promise<std::unique_ptr<Level>> firstChunks;
+    std::future<std::unique_ptr<Level>> levelReady;
+    std::future<ChunkGrid> gridReady;
+    std::atomic<const char*> status{ "starting" };
+    std::atomic<bool> cancel{ false };
+    bool complete = false;
+    bool failed = false;
+};
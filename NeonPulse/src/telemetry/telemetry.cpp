@@ -0,0 +1,190 @@
+#include "telemetry.h"
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cstring>
+
+using namespace std;
+
+// -------------------------
+// Log file layout
+// -------------------------
+// header: "NPTL" magic, uint32 version, uint32 record size
+// body:   TelemetryRecord[]
+// -------------------------
+
+static const char kTelemetryMagic[4] = { 'N', 'P', 'T', 'L' };
+static const uint32_t kTelemetryVersion = 1;
+
+// -------------------------
+// TelemetryQueue
+// -------------------------
+
+size_t TelemetryQueue::PopAll(vector<TelemetryRecord>& out) {
+    uint32_t tail = tail_.load(memory_order_relaxed);
+    uint32_t head = head_.load(memory_order_acquire);
+    size_t count = head - tail;
+    for (uint32_t i = tail; i != head; ++i) {
+        out.push_back(records_[i & (kCapacity - 1)]);
+    }
+    tail_.store(head, memory_order_release);
+    return count;
+}
+
+// -------------------------
+// TelemetryWriter
+// -------------------------
+
+bool TelemetryWriter::Start(const string& path) {
+    if (running_.load()) return true;
+
+    file_ = fopen(path.c_str(), "wb");
+    if (!file_) return false;
+
+    uint32_t recordSize = (uint32_t)sizeof(TelemetryRecord);
+    fwrite(kTelemetryMagic, 1, sizeof(kTelemetryMagic), file_);
+    fwrite(&kTelemetryVersion, sizeof(kTelemetryVersion), 1, file_);
+    fwrite(&recordSize, sizeof(recordSize), 1, file_);
+
+    running_.store(true);
+    thread_ = thread(&TelemetryWriter::ThreadMain, this);
+    return true;
+}
+
+void TelemetryWriter::Stop() {
+    if (!running_.exchange(false)) return;
+    if (thread_.joinable()) thread_.join();
+
+    // pick up anything pushed between the last drain and the flag flip
+    vector<TelemetryRecord> scratch;
+    Drain(scratch);
+
+    fclose(file_);
+    file_ = nullptr;
+}
+
+void TelemetryWriter::Drain(vector<TelemetryRecord>& scratch) {
+    scratch.clear();
+    if (queue_.PopAll(scratch) > 0) {
+        fwrite(scratch.data(), sizeof(TelemetryRecord), scratch.size(), file_);
+    }
+}
+
+void TelemetryWriter::ThreadMain() {
+    vector<TelemetryRecord> scratch;
+    scratch.reserve(TelemetryQueue::kCapacity);
+    while (running_.load()) {
+        Drain(scratch);
+        this_thread::sleep_for(chrono::milliseconds(10));
+    }
+    fflush(file_);
+}
+
+// -------------------------
+// Offline aggregation
+// -------------------------
+
+bool ReadTelemetryLog(const string& path, vector<TelemetryRecord>& out) {
+    FILE* f = fopen(path.c_str(), "rb");
+    if (!f) return false;
+
+    char magic[4];
+    uint32_t version = 0, recordSize = 0;
+    bool ok = fread(magic, 1, 4, f) == 4 && memcmp(magic, kTelemetryMagic, 4) == 0 &&
+        fread(&version, sizeof(version), 1, f) == 1 && version == kTelemetryVersion &&
+        fread(&recordSize, sizeof(recordSize), 1, f) == 1 && recordSize == sizeof(TelemetryRecord);
+
+    if (ok) {
+        TelemetryRecord r;
+        while (fread(&r, sizeof(r), 1, f) == 1) out.push_back(r);
+    }
+    fclose(f);
+    return ok;
+}
+
+TelemetryReport BuildTelemetryReport(const vector<string>& paths,
+    const vector<Section>& sections, float bucketWidth) {
+    TelemetryReport report;
+    report.bucketWidth = bucketWidth;
+    report.funnel.resize(sections.size());
+
+    float levelEnd = sections.empty() ? 0.0f : sections.back().endX;
+    report.deathBuckets.assign((size_t)(levelEnd / bucketWidth) + 1, 0);
+
+    // The last section runs on to the finish line, as in CurrentSection, so
+    // it is only passed by finishing
+    auto sectionEnd = [&](size_t i) { return i + 1 == sections.size() ? FLT_MAX : sections[i].endX; };
+
+    // A run ends on death, on finish, or when the next run starts (restart/quit).
+    auto closeRun = [&](float furthestX, bool finished) {
+        report.runs++;
+        if (finished) report.completions++;
+        for (size_t i = 0; i < sections.size(); ++i) {
+            if (furthestX < sections[i].startX) break;
+            report.funnel[i].reached++;
+            if (finished || furthestX >= sectionEnd(i)) report.funnel[i].passed++;
+        }
+    };
+
+    vector<TelemetryRecord> records;
+    for (const auto& path : paths) {
+        records.clear();
+        if (!ReadTelemetryLog(path, records)) {
+            printf("telemetry: skipping unreadable log %s\n", path.c_str());
+            continue;
+        }
+
+        bool inRun = false;
+        float furthestX = 0.0f;
+        for (const auto& r : records) {
+            if (r.type == TELEMETRY_RUN_START) {
+                if (inRun) closeRun(furthestX, false);
+                inRun = true;
+                furthestX = r.x;
+                continue;
+            }
+            if (!inRun) continue;
+            furthestX = max(furthestX, r.x);
+
+            if (r.type == TELEMETRY_DEATH) {
+                size_t bucket = (size_t)max(0.0f, r.x / bucketWidth);
+                if (bucket >= report.deathBuckets.size()) report.deathBuckets.resize(bucket + 1, 0);
+                report.deathBuckets[bucket]++;
+                for (size_t i = 0; i < sections.size(); ++i) {
+                    if (r.x >= sections[i].startX && r.x < sectionEnd(i)) report.funnel[i].deaths++;
+                }
+                closeRun(furthestX, false);
+                inRun = false;
+            }
+            else if (r.type == TELEMETRY_LEVEL_FINISHED) {
+                closeRun(furthestX, true);
+                inRun = false;
+            }
+        }
+        if (inRun) closeRun(furthestX, false);
+    }
+    return report;
+}
+
+void PrintTelemetryReport(const TelemetryReport& report, const vector<Section>& sections) {
+    printf("runs: %d  completions: %d\n\n", report.runs, report.completions);
+
+    printf("death heatmap (bucket = %.0fpx)\n", report.bucketWidth);
+    int peak = 0;
+    for (int c : report.deathBuckets) peak = max(peak, c);
+    for (size_t i = 0; i < report.deathBuckets.size(); ++i) {
+        int c = report.deathBuckets[i];
+        if (c == 0) continue;
+        int bar = peak > 0 ? (c * 50 + peak - 1) / peak : 0;
+        printf("  x %6.0f-%6.0f %6d %s\n", i * report.bucketWidth, (i + 1) * report.bucketWidth, c,
+            string((size_t)bar, '#').c_str());
+    }
+
+    printf("\nsection funnel\n");
+    for (size_t i = 0; i < sections.size(); ++i) {
+        const SectionFunnel& f = report.funnel[i];
+        float passRate = f.reached > 0 ? 100.0f * f.passed / f.reached : 0.0f;
+        printf("  section %zu [%6.0f-%6.0f] reached %6d  died %6d  passed %6d (%5.1f%%)\n",
+            i, sections[i].startX, sections[i].endX, f.reached, f.deaths, f.passed, passRate);
+    }
+}
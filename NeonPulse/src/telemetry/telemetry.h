@@ -0,0 +1,109 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../entities/entities.h"
+
+// -------------------------
+// Gameplay telemetry
+// -------------------------
+// The game thread pushes fixed-size records into a lock-free single-producer
+// ring; a background thread drains them into a binary log so gameplay never
+// waits on file I/O. Logs are aggregated offline into death heatmaps and
+// per-section completion funnels.
+// -------------------------
+
+enum TelemetryEvent : uint8_t {
+    TELEMETRY_RUN_START = 0,
+    TELEMETRY_DEATH,
+    TELEMETRY_JUMP_PAD,
+    TELEMETRY_SPEED_PAD,
+    TELEMETRY_GRAVITY_PAD,
+    TELEMETRY_LEVEL_FINISHED,
+};
+
+// 16 bytes, written to disk as-is
+struct TelemetryRecord {
+    uint8_t type;
+    int8_t gravityDir;
+    uint16_t run;
+    float x;
+    float y;
+    float time;
+};
+
+class TelemetryQueue {
+public:
+    static const uint32_t kCapacity = 4096; // must be a power of two
+
+    // Producer side (game thread only). Drops the record if the ring is full.
+    bool Push(const TelemetryRecord& r) {
+        uint32_t head = head_.load(std::memory_order_relaxed);
+        if (head - tail_.load(std::memory_order_acquire) == kCapacity) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        records_[head & (kCapacity - 1)] = r;
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side (writer thread only). Returns the number of records copied.
+    size_t PopAll(std::vector<TelemetryRecord>& out);
+
+    uint32_t Dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    TelemetryRecord records_[kCapacity];
+    alignas(64) std::atomic<uint32_t> head_{ 0 };
+    alignas(64) std::atomic<uint32_t> tail_{ 0 };
+    std::atomic<uint32_t> dropped_{ 0 };
+};
+
+class TelemetryWriter {
+public:
+    ~TelemetryWriter() { Stop(); }
+
+    bool Start(const std::string& path);
+    void Stop();
+
+    void Emit(TelemetryEvent type, int run, float x, float y, int gravityDir, float time) {
+        if (!running_.load(std::memory_order_relaxed)) return;
+        queue_.Push({ (uint8_t)type, (int8_t)gravityDir, (uint16_t)run, x, y, time });
+    }
+
+private:
+    void Drain(std::vector<TelemetryRecord>& scratch);
+    void ThreadMain();
+
+    TelemetryQueue queue_;
+    std::atomic<bool> running_{ false };
+    std::thread thread_;
+    FILE* file_ = nullptr;
+};
+
+// -------------------------
+// Offline aggregation
+// -------------------------
+
+struct SectionFunnel {
+    int reached = 0;
+    int deaths = 0;
+    int passed = 0;
+};
+
+struct TelemetryReport {
+    float bucketWidth = 100.0f;
+    int runs = 0;
+    int completions = 0;
+    std::vector<int> deathBuckets;     // deaths per x bucket
+    std::vector<SectionFunnel> funnel; // one entry per level section
+};
+
+bool ReadTelemetryLog(const std::string& path, std::vector<TelemetryRecord>& out);
+TelemetryReport BuildTelemetryReport(const std::vector<std::string>& paths,
+    const std::vector<Section>& sections, float bucketWidth);
+void PrintTelemetryReport(const TelemetryReport& report, const std::vector<Section>& sections);